@@ -0,0 +1,43 @@
+#include "AudioAnalyzeLevel.h"
+
+void AudioAnalyzeLevel::update(void) {
+    audio_block_t *block = receiveReadOnly();
+    if (!block) {
+        count += AUDIO_BLOCK_SAMPLES;   // silent input still ages the window
+        return;
+    }
+
+    uint16_t peak = 0;
+    uint64_t sum  = 0;
+    for (uint16_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        int32_t s = block->data[i];
+        uint16_t a = (s < 0) ? -s : s;
+        if (a > peak) peak = a;
+        sum += (uint32_t)(s * s);
+    }
+    AudioStream::release(block);
+
+    if (peak > peakAbs) peakAbs = peak;
+    if (peak >= LEVEL_CLIP_THRESHOLD) clipped = true;
+    sumSquares += sum;
+    count += AUDIO_BLOCK_SAMPLES;
+}
+
+LevelReading AudioAnalyzeLevel::read() {
+    __disable_irq();
+    uint16_t peak = peakAbs;
+    uint64_t sum  = sumSquares;
+    uint32_t n    = count;
+    bool     clip = clipped;
+    peakAbs    = 0;
+    sumSquares = 0;
+    count      = 0;
+    clipped    = false;
+    __enable_irq();
+
+    LevelReading r;
+    r.peak = peak / 32768.0f;
+    r.rms  = n ? sqrtf((float)sum / n) / 32768.0f : 0.0f;
+    r.clip = clip;
+    return r;
+}
@@ -0,0 +1,36 @@
+#ifndef AUDIOANALYZELEVEL_H
+#define AUDIOANALYZELEVEL_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+// ------------------ CONFIG ------------------
+#define LEVEL_CLIP_THRESHOLD 32767      // |sample| at or above counts as a clip
+
+struct LevelReading {
+    float peak;         // 0..1, max |sample| since the last read
+    float rms;          // 0..1, over the same window
+    bool  clip;         // a sample reached full scale in the window
+};
+
+// Meter tap: a sink that reads its input block in place, keeps a running
+// max and sum of squares, and releases it. No blocks are allocated, so a
+// tap costs one pass over 128 samples.
+class AudioAnalyzeLevel : public AudioStream {
+public:
+    AudioAnalyzeLevel() : AudioStream(1, inputQueueArray) {}
+
+    // Returns the window since the last call and starts a new one
+    LevelReading read();
+
+    virtual void update(void);
+
+private:
+    audio_block_t* inputQueueArray[1];
+    volatile uint16_t peakAbs = 0;
+    volatile uint64_t sumSquares = 0;
+    volatile uint32_t count = 0;
+    volatile bool     clipped = false;
+};
+
+#endif
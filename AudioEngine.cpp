@@ -1,31 +1,18 @@
 #include "AudioEngine.h"
 #include "Sequencer.h"
+#include "Params.h"
 
 namespace AudioEngine {
     
     // ------------------ AUDIO OBJECTS ------------------
-    AudioMixer4             mixMain;
-
-    AudioOutputI2S          i2s1;
-    AudioControlSGTL5000    sgtl5000_1;
-
-    // SYNTH ENGINE
-    AudioConnection*        patchCordsSynth[NUM_VOICES * 4 + 4];
-    AudioConnection*        patchCordsSampler[NUM_SAMPLER_VOICES * 2];
-
     // METRO
     AudioSynthWaveform      metroOsc;
     AudioEffectEnvelope     metroEnv;
-    AudioConnection         patchMetro1(metroOsc, metroEnv);
-    AudioConnection         patchMetro2(metroEnv, 0, mixMain, 2);   // MAIN CH 2 
-
-    // OUTPUT
-    AudioConnection         patchMainL(mixMain, 0, i2s1, 0);
-    AudioConnection         patchMainR(mixMain, 0, i2s1, 1);   
 
     // ------------------ SAMPLER ------------------
 
     SamplerVoice samplerVoices[NUM_SAMPLER_VOICES];
+    AudioMixer4  mixSampler;            // sums sampler voices (engine output)
     Sample samplePool[MAX_SAMPLES];
 
     int8_t samplerTrackVoiceMap[MAX_TRACKS][128];  // -1 = free
@@ -36,18 +23,309 @@ namespace AudioEngine {
                 samplerTrackVoiceMap[t][n] = -1;
     }
 
+    static uint8_t samplerVoiceLimit = NUM_SAMPLER_VOICES;
+    static int8_t lastTrackSample[MAX_TRACKS];      // for the waveform page
+    static uint32_t samplerTriggerCount = 0;
+
+    // Silent: player done, or released and envelope finished
+    inline bool samplerVoiceIdle(SamplerVoice &voice) {
+        if (!voice.player.isPlaying()) return true;
+        return !voice.active && !voice.env.isActive();
+    }
+
+    static inline bool startedBefore(const SamplerVoice &a, const SamplerVoice &b) {
+        return a.startOrder - b.startOrder > 0x80000000u;
+    }
+
+    // Idle voices first, then the oldest released voice, then the oldest
+    // sounding one. Choked voices go last: play() would cut their fade
+    // short, and the voice just choked by a retrigger is one of them.
     int findFreeSamplerVoice() {
+        int released = -1, sounding = -1, fading = -1;
+        for (int i = 0; i < samplerVoiceLimit; i++) {
+            SamplerVoice &voice = samplerVoices[i];
+            if (samplerVoiceIdle(voice)) return i;
+
+            int &best = voice.player.isFading() ? fading : (voice.active ? sounding : released);
+            if (best < 0 || startedBefore(voice, samplerVoices[best])) best = i;
+        }
+        if (released >= 0) return released;
+        if (sounding >= 0) return sounding;     // voice steal
+        return fading;
+    }
+
+    // Frees a voice with a short fade instead of a hard stop
+    void chokeSamplerVoice(int v) {
+        SamplerVoice &voice = samplerVoices[v];
+        if (voice.active && samplerTrackVoiceMap[voice.trackId][voice.note] == v)
+            samplerTrackVoiceMap[voice.trackId][voice.note] = -1;
+        voice.player.fadeOut(VOICE_CHOKE_SAMPLES);
+        voice.env.noteOff();
+        voice.active = false;
+    }
+
+    void chokeSamplerGroup(uint8_t trackId, uint8_t group) {
+        if (!group) return;
         for (int i = 0; i < NUM_SAMPLER_VOICES; i++) {
-            if (!samplerVoices[i].active)
-                return i;
+            SamplerVoice &voice = samplerVoices[i];
+            if (voice.trackId != trackId || voice.chokeGroup != group) continue;
+            if (samplerVoiceIdle(voice) || voice.player.isFading()) continue;
+            chokeSamplerVoice(i);
         }
-        return 0; // voice steal
     }
 
-    void loadAndAssignPad(const char* filename, uint8_t padId) {
-        //if (padId >= MAX_SAMPLES) return;
+    // Stops players whose envelope has released, so looped samples stop costing CPU
+    void updateSamplerVoices() {
+        for (int i = 0; i < NUM_SAMPLER_VOICES; i++) {
+            SamplerVoice &voice = samplerVoices[i];
+            if (!voice.active && voice.player.isPlaying() && !voice.env.isActive())
+                voice.player.stop();
+        }
+    }
 
-        samplePool[padId].filename = filename;
+    // ------------------ SAMPLER ENVELOPES ------------------
+    static SamplerEnvelope samplerEnv[MAX_TRACKS];
+    static const SamplerEnvelope defaultSamplerEnv = { 0.0f, 0.0f, 0.0f, 1.0f, 30.0f };
+
+    void setSamplerEnvelope(uint8_t trackId, const SamplerEnvelope &env) {
+        if (trackId >= MAX_TRACKS) return;
+        samplerEnv[trackId] = env;
+        samplerEnv[trackId].sustain = constrain(env.sustain, 0.0f, 1.0f);
+    }
+
+    const SamplerEnvelope& getSamplerEnvelope(uint8_t trackId) {
+        if (trackId >= MAX_TRACKS) return defaultSamplerEnv;
+        return samplerEnv[trackId];
+    }
+
+    // ------------------ SAMPLE CACHE ------------------
+    static uint32_t sampleMemoryUsed = 0;
+
+    // Min/max overview at PEAK_LEVELS resolutions, each level built from the
+    // one below. One PSRAM block holds all levels.
+    static bool buildPeaks(Sample &s) {
+        uint32_t total = 0;
+        for (uint8_t l = 0; l < PEAK_LEVELS; l++) {
+            s.peakCount[l] = (s.length + peakFrames(l) - 1) / peakFrames(l);
+            total += s.peakCount[l];
+        }
+
+        PeakPair* block = (PeakPair*)extmem_malloc(total * sizeof(PeakPair));
+        if (!block) return false;
+        for (uint8_t l = 0; l < PEAK_LEVELS; l++) {
+            s.peaks[l] = block;
+            block += s.peakCount[l];
+        }
+
+        for (uint32_t p = 0; p < s.peakCount[0]; p++) {
+            uint32_t f0 = p * PEAK_BASE_FRAMES;
+            uint32_t f1 = min(f0 + PEAK_BASE_FRAMES, s.length);
+            int16_t lo = s.data[f0], hi = s.data[f0];
+            for (uint32_t f = f0 + 1; f < f1; f++) {
+                if (s.data[f] < lo) lo = s.data[f];
+                if (s.data[f] > hi) hi = s.data[f];
+            }
+            s.peaks[0][p] = { (int8_t)(lo >> 8), (int8_t)(hi >> 8) };
+        }
+
+        for (uint8_t l = 1; l < PEAK_LEVELS; l++) {
+            for (uint32_t p = 0; p < s.peakCount[l]; p++) {
+                uint32_t c0 = p * 4;
+                uint32_t c1 = min(c0 + 4, s.peakCount[l - 1]);
+                PeakPair pk = s.peaks[l - 1][c0];
+                for (uint32_t c = c0 + 1; c < c1; c++) {
+                    if (s.peaks[l - 1][c].min < pk.min) pk.min = s.peaks[l - 1][c].min;
+                    if (s.peaks[l - 1][c].max > pk.max) pk.max = s.peaks[l - 1][c].max;
+                }
+                s.peaks[l][p] = pk;
+            }
+        }
+        sampleMemoryUsed += total * sizeof(PeakPair);
+        return true;
+    }
+
+    // Loads a 16 bit mono .raw file into RAM (PSRAM when fitted). Load time only.
+    bool loadSample(int idx) {
+        if (idx < 0 || idx >= MAX_SAMPLES) return false;
+        Sample &s = samplePool[idx];
+        if (!s.filename[0]) return false;
+        if (s.data) return true;    // already cached
+
+        File f = SD.open(s.filename);
+        if (!f) {
+            Serial.printf("Sample %s not found\n", s.filename);
+            return false;
+        }
+
+        uint32_t frames = f.size() / sizeof(int16_t);
+        int16_t* data = (int16_t*)extmem_malloc(frames * sizeof(int16_t));
+        if (!data) {
+            Serial.printf("No memory for %s (%lu frames)\n", s.filename, (unsigned long)frames);
+            f.close();
+            return false;
+        }
+
+        uint8_t* dst = (uint8_t*)data;
+        uint32_t remaining = frames * sizeof(int16_t);
+        while (remaining) {
+            int n = f.read(dst, remaining > 4096 ? 4096 : remaining);
+            if (n <= 0) break;
+            dst += n;
+            remaining -= n;
+        }
+        f.close();
+
+        s.data      = data;
+        s.length    = frames - remaining / sizeof(int16_t);
+        s.start     = 0;
+        s.end       = s.length;
+        s.loopStart = 0;
+        s.loopEnd   = 0;
+        sampleMemoryUsed += frames * sizeof(int16_t);
+
+        if (s.length && !buildPeaks(s))
+            Serial.printf("No memory for %s overview\n", s.filename);
+        return true;
+    }
+
+    // Returns the cache slot holding filename, loading it on first use
+    int8_t acquireSample(const char* filename) {
+        if (!filename || !filename[0]) return -1;
+
+        int8_t freeSlot = -1;
+        for (int8_t i = 0; i < MAX_SAMPLES; i++) {
+            if (!samplePool[i].filename[0]) {
+                if (freeSlot < 0) freeSlot = i;
+                continue;
+            }
+            if (strncmp(samplePool[i].filename, filename, MAX_SAMPLE_NAME) == 0)
+                return loadSample(i) ? i : -1;
+        }
+        if (freeSlot < 0) {
+            Serial.println("Sample cache full");
+            return -1;
+        }
+
+        Sample &s = samplePool[freeSlot];
+        s = {};
+        strncpy(s.filename, filename, MAX_SAMPLE_NAME - 1);
+        if (!loadSample(freeSlot)) {
+            s.filename[0] = 0;
+            return -1;
+        }
+        return freeSlot;
+    }
+
+    // ------------------ KEYMAP ------------------
+    #define VEL_ZONE_WIDTH (128 / VEL_ZONES)
+
+    DMAMEM Keymap keymaps[MAX_TRACKS];
+    Keymap padKeymap;
+
+    void clearKeymap(Keymap &km) {
+        km.numZones = 0;
+        memset(km.lut, NO_ZONE, sizeof(km.lut));
+    }
+
+    int8_t addKeyZone(Keymap &km, const KeyZone &zone) {
+        if (km.numZones >= MAX_KEYZONES) return -1;
+        if (zone.loKey > zone.hiKey || zone.loVel > zone.hiVel) return -1;
+        if (zone.hiKey > 127 || zone.hiVel > 127) return -1;     // lut bounds
+        km.zones[km.numZones] = zone;
+        return km.numZones++;
+    }
+
+    // Precomputes the key x velocity table; earlier zones win on overlap.
+    // Zones sharing a round-robin group are linked into a cycle and the
+    // table points at the first zone of the group.
+    void buildKeymap(Keymap &km) {
+        uint8_t head[MAX_KEYZONES];
+
+        for (uint8_t z = 0; z < km.numZones; z++) {
+            head[z] = z;
+            if (km.zones[z].rrGroup) {
+                for (uint8_t h = 0; h < z; h++) {
+                    if (km.zones[h].rrGroup == km.zones[z].rrGroup) { head[z] = h; break; }
+                }
+            }
+            km.rrCursor[z] = z;
+        }
+
+        for (uint8_t z = 0; z < km.numZones; z++) {
+            KeyZone &zone = km.zones[z];
+            zone.rrNext = head[z];
+            if (!zone.rrGroup) continue;
+            for (uint8_t n = z + 1; n < km.numZones; n++) {
+                if (km.zones[n].rrGroup == zone.rrGroup) { zone.rrNext = n; break; }
+            }
+        }
+
+        memset(km.lut, NO_ZONE, sizeof(km.lut));
+        for (uint8_t z = 0; z < km.numZones; z++) {
+            const KeyZone &zone = km.zones[z];
+            for (uint8_t vz = 0; vz < VEL_ZONES; vz++) {
+                uint8_t velMid = vz * VEL_ZONE_WIDTH + VEL_ZONE_WIDTH / 2;
+                if (velMid < zone.loVel || velMid > zone.hiVel) continue;
+                for (uint16_t key = zone.loKey; key <= zone.hiKey; key++) {
+                    if (km.lut[key][vz] == NO_ZONE) km.lut[key][vz] = head[z];
+                }
+            }
+        }
+    }
+
+    int8_t assignSampleZone(uint8_t trackId, const char* filename,
+                            uint8_t loKey, uint8_t hiKey, uint8_t rootNote,
+                            uint8_t loVel, uint8_t hiVel, uint8_t rrGroup,
+                            uint8_t chokeGroup) {
+        if (trackId >= MAX_TRACKS) return -1;
+        int8_t idx = acquireSample(filename);
+        if (idx < 0) return -1;
+
+        KeyZone zone = { loKey, hiKey, loVel, hiVel, rootNote, (uint8_t)idx, rrGroup, NO_ZONE, chokeGroup };
+        int8_t z = addKeyZone(keymaps[trackId], zone);
+        if (z >= 0) buildKeymap(keymaps[trackId]);
+        return z;
+    }
+
+    // O(1): one table read plus a round-robin step
+    const KeyZone* resolveZone(uint8_t trackId, uint8_t note, uint8_t vel) {
+        if (trackId >= MAX_TRACKS || note > 127 || vel > 127) return nullptr;
+
+        Keymap &km = keymaps[trackId].numZones ? keymaps[trackId] : padKeymap;
+        uint8_t z = km.lut[note][vel / VEL_ZONE_WIDTH];
+        if (z == NO_ZONE) return nullptr;
+
+        if (km.zones[z].rrGroup) {
+            uint8_t play = km.rrCursor[z];
+            km.rrCursor[z] = km.zones[play].rrNext;
+            z = play;
+        }
+        return &km.zones[z];
+    }
+
+    // Pad kit: one unpitched sample per pad note, shared by all tracks
+    void loadAndAssignPad(const char* filename, uint8_t padId) {
+        if (padId > 127 - 47) return;       // pad key must stay a MIDI note
+        int8_t idx = acquireSample(filename);
+        if (idx < 0) return;
+
+        uint8_t key = 47 + padId;
+
+        // Replace any zone already on this pad
+        for (uint8_t z = 0; z < padKeymap.numZones; z++) {
+            KeyZone &zone = padKeymap.zones[z];
+            if (zone.loKey == key && zone.hiKey == key) {
+                zone.sampleIdx = idx;
+                buildKeymap(padKeymap);
+                idx = -1;
+                break;
+            }
+        }
+        if (idx >= 0) {
+            KeyZone zone = { key, key, 1, 127, key, (uint8_t)idx, 0, NO_ZONE, 0 };
+            addKeyZone(padKeymap, zone);
+            buildKeymap(padKeymap);
+        }
 
         Serial.print("Assigned ");
         Serial.print(filename);
@@ -55,29 +333,80 @@ namespace AudioEngine {
         Serial.println(padId);
     }
 
+    int8_t lastSampleOnTrack(uint8_t trackId) {
+        return (trackId < MAX_TRACKS) ? lastTrackSample[trackId] : -1;
+    }
+
+    // e.g. closed and open hat on one group: the closed hat cuts the open one
+    void setPadChokeGroup(uint8_t padId, uint8_t group) {
+        uint8_t key = 47 + padId;
+        for (uint8_t z = 0; z < padKeymap.numZones; z++) {
+            KeyZone &zone = padKeymap.zones[z];
+            if (zone.loKey == key && zone.hiKey == key) zone.chokeGroup = group;
+        }
+    }
+
+    // ------------------ SAMPLER VOICES ------------------
+    static SampleInterp samplerInterp = SampleInterp::LINEAR;
+
+    void setSamplerInterpolation(SampleInterp mode) {
+        samplerInterp = mode;
+        for (int i = 0; i < NUM_SAMPLER_VOICES; i++)
+            samplerVoices[i].player.setInterpolation(mode);
+    }
+
+    inline float noteToRate(uint8_t note, uint8_t rootNote) {
+        return powf(2.0f, (int(note) - int(rootNote)) / 12.0f);
+    }
+
+    // Squared velocity curve, closer to perceived loudness than linear
+    inline float velocityToGain(uint8_t vel) {
+        float v = vel / 127.0f;
+        return v * v;
+    }
+
     void samplerNoteOn(uint8_t trackId, uint8_t note, uint8_t vel) {
-        int sampleIdx = note-47;
-        const char* fn = samplePool[sampleIdx].filename;
+        const KeyZone* zone = resolveZone(trackId, note, vel);
 
-        if (sampleIdx < 0 || sampleIdx >= MAX_SAMPLES || !fn) {
+        if (!zone || !samplePool[zone->sampleIdx].data) {
             //Serial.printf("No sample mapped for pad %d\n", padId);
             return; 
         }
+        int sampleIdx = zone->sampleIdx;
+        const Sample &s = samplePool[sampleIdx];
+
+        // Retrigger and choke group fade out first, so their voices are
+        // free for the allocator below
+        int prev = samplerTrackVoiceMap[trackId][note];
+        if (prev >= 0) chokeSamplerVoice(prev);
+        chokeSamplerGroup(trackId, zone->chokeGroup);
+
         int v = findFreeSamplerVoice();
         SamplerVoice &voice = samplerVoices[v];
-
-        if (voice.player.isPlaying())
-            voice.player.stop();
+        if (voice.active && samplerTrackVoiceMap[voice.trackId][voice.note] == v)
+            samplerTrackVoiceMap[voice.trackId][voice.note] = -1;
 
         voice.trackId = trackId;
         voice.note    = note;
+        voice.chokeGroup  = zone->chokeGroup;
         voice.sampleIndex = sampleIdx;
+        voice.startOrder  = samplerTriggerCount++;
         voice.active  = true;
 
         samplerTrackVoiceMap[trackId][note] = v;
+        lastTrackSample[trackId] = sampleIdx;
+
+        const SamplerEnvelope &e = samplerEnv[trackId];
+        voice.env.attack(e.attack);
+        voice.env.hold(e.hold);
+        voice.env.decay(e.decay);
+        voice.env.sustain(e.sustain);
+        voice.env.release(e.release);
 
         //Serial.printf("Track %d triggered pad %d → sample %d\n", trackId, padId, sampleIdx);
-        voice.player.play(samplePool[sampleIdx].filename);
+        voice.player.play(s.data, s.start, s.end, s.loopStart, s.loopEnd,
+                          noteToRate(note, zone->rootNote), velocityToGain(vel));
+        voice.env.noteOn();
     }
 
     void samplerNoteOff(uint8_t trackId, uint8_t padId) {
@@ -85,7 +414,7 @@ namespace AudioEngine {
         if (v >= 0) {
             SamplerVoice &voice = samplerVoices[v];
             if (voice.trackId == trackId) {
-                voice.player.stop();
+                voice.env.noteOff();    // player is stopped once the release ends
                 voice.active = false;
                 samplerTrackVoiceMap[trackId][padId] = -1;
                 Serial.printf("Track %d released pad %d\n", trackId, padId);
@@ -93,6 +422,52 @@ namespace AudioEngine {
         }
     }
 
+    float samplerCpuUsage() {
+        float usage = 0.0f;
+        for (int i = 0; i < NUM_SAMPLER_VOICES; i++) {
+            usage += samplerVoices[i].player.processorUsage();
+            usage += samplerVoices[i].env.processorUsage();
+            usage += samplerVoices[i].mixSample.processorUsage();
+        }
+        return usage + mixSampler.processorUsage();
+    }
+
+    // Times the voice render loop on a synthetic sample and prints how many
+    // voices fit into one audio block period.
+    void benchmarkSampler() {
+        static int16_t testData[4096];
+        for (int i = 0; i < 4096; i++)
+            testData[i] = (int16_t)(sinf(i * 0.05f) * 20000.0f);
+
+        const uint32_t blockCycles =
+            (uint32_t)(F_CPU_ACTUAL / (AUDIO_SAMPLE_RATE_EXACT / AUDIO_BLOCK_SAMPLES));
+        const uint16_t blocks = 64;
+        int16_t out[AUDIO_BLOCK_SAMPLES];
+
+        for (uint8_t m = 0; m < 2; m++) {
+            SampleVoiceState st;
+            st.data      = testData;
+            st.end       = 4096;
+            st.loopStart = 0;
+            st.loopEnd   = 4096;
+            st.increment = (uint64_t)(1.4983f * 4294967296.0);   // +7 semitones
+            st.gain      = 1.0f;
+            st.fade      = 1.0f;
+            st.interp    = m ? SampleInterp::CUBIC : SampleInterp::LINEAR;
+            st.playing   = true;
+
+            uint32_t t0 = ARM_DWT_CYCCNT;
+            for (uint16_t b = 0; b < blocks; b++)
+                renderSampleVoice(st, out, AUDIO_BLOCK_SAMPLES);
+            uint32_t perBlock = (ARM_DWT_CYCCNT - t0) / blocks;
+
+            Serial.printf("Sampler %s: %lu cycles/block, %.1f%% CPU/voice, %lu voices/block\n",
+                          m ? "cubic" : "linear", (unsigned long)perBlock,
+                          100.0f * perBlock / blockCycles,
+                          (unsigned long)(perBlock ? blockCycles / perBlock : 0));
+        }
+    }
+
     void muteSamplerTrack(uint8_t trackId) {
         if (trackId >= MAX_TRACKS) return;
 
@@ -115,19 +490,24 @@ namespace AudioEngine {
 
     float midiToFreq(uint8_t note) {return 440.0f * pow(2.0f, float(note - 69) / 12.0f);}
 
-    int findFreeVoice() {
-        for (int i = 0; i < NUM_VOICES; i++) {
+    static uint8_t synthVoiceLimit = VOICES_PER_ENGINE;   // polyphony per engine
+
+    // Each engine owns VOICES_PER_ENGINE consecutive voices
+    int findFreeVoice(uint8_t engine) {
+        if (engine >= MAX_ENGINES) engine = 0;
+        int base = engine * VOICES_PER_ENGINE;
+        for (int i = base; i < base + synthVoiceLimit; i++) {
             if (!voices[i].env.isActive())
                 return i;
         }
-        return 0; // simple voice steal
+        return base; // simple voice steal
     }
 
     void noteOn(uint8_t trackId, uint8_t note, uint8_t vel) {
 
         if (trackId >= MAX_TRACKS) return;
 
-        int v = findFreeVoice();
+        int v = findFreeVoice(Sequencer::curSeq().tracks[trackId].engine);
         Voice& voice = voices[v];
 
         voice.note   = note;
@@ -167,6 +547,21 @@ namespace AudioEngine {
         }
     }
 
+    float synthCpuUsage() {
+        float usage = 0.0f;
+        for (int i = 0; i < NUM_VOICES; i++) {
+            Voice& voice = voices[i];
+            usage += voice.oscA.processorUsage() + voice.oscB.processorUsage();
+            usage += voice.oscMix.processorUsage() + voice.env.processorUsage();
+        }
+        for (int e = 0; e < MAX_ENGINES; e++) {
+            usage += engines[e].mix.processorUsage();
+            usage += engines[e].crusher.processorUsage();
+            usage += engines[e].filter.processorUsage();
+        }
+        return usage;
+    }
+
     void allNotesOff() {
         metroEnv.noteOff();
         for (int t = 0; t < MAX_TRACKS; t++)
@@ -251,42 +646,69 @@ namespace AudioEngine {
         }
     }
 
-    void setSynthParam(EncParam param, float value) {
+    static bool    fxBypassed  = false;
+    static uint8_t crusherBits[MAX_ENGINES] = {24, 24, 24, 24};   // user setting, restored after bypass
+
+    // Edits the engine of a track and its voices. Tracks sharing an engine
+    // share its sound; the last track selected or edited sets it.
+    void setSynthParam(uint8_t trackId, EncParam param, float value) {
+        if (trackId >= MAX_TRACKS) return;
+        Sequencer::Track &trk = Sequencer::curSeq().tracks[trackId];
+
+        // Envelope page edits the sampler envelope on sampler tracks
+        if ((Sequencer::TrackType)trk.type == Sequencer::TrackType::SAMPLER) {
+            SamplerEnvelope &env = samplerEnv[trackId];
+            switch (param) {
+                case EncParam::ENV_ATT: env.attack  = value; return;
+                case EncParam::ENV_DEC: env.decay   = value; return;
+                case EncParam::ENV_SUS: env.sustain = constrain(value, 0.0f, 1.0f); return;
+                case EncParam::ENV_REL: env.release = value; return;
+                default: return;            // a sampler track has no synth engine
+            }
+        }
+
+        uint8_t e = trk.engine;
+        if (e >= MAX_ENGINES) e = 0;
+        SynthEngine &eng = engines[e];
+        const int first = e * VOICES_PER_ENGINE;
+        const int last  = first + VOICES_PER_ENGINE;
+
         switch (param) {
             case EncParam::FILTER_CUTOFF:
-                engines[0].filter.frequency(value);
+                eng.filter.frequency(value);
                 break;
             case EncParam::FILTER_RESONANCE:
-                engines[0].filter.resonance(value);
+                eng.filter.resonance(value);
                 break;
             case EncParam::BITCRUSH_BITS:
-                engines[0].crusher.bits((int)value);
+                crusherBits[e] = (uint8_t)value;
+                if (!fxBypassed) eng.crusher.bits(crusherBits[e]);
                 break;
             case EncParam::OSC1_PULSE: {
                 static const float dutyTable[] = {
                     0.125f, 0.25f, 0.5f, 0.75f
                 };
                 int idx = constrain((int)value, 0, 3);
-                for (int i = 0; i < NUM_VOICES; i++) {
+                for (int i = first; i < last; i++) {
                     voices[i].oscA.pulseWidth(dutyTable[idx]);
                     voices[i].oscB.pulseWidth(dutyTable[idx]);
                 }
                 break;
             }
             case EncParam::ENV_ATT:
-                for (int i = 0; i < NUM_VOICES; i++)
+                for (int i = first; i < last; i++)
                     voices[i].env.attack(value);
                 break;
             case EncParam::ENV_DEC:
-                for (int i = 0; i < NUM_VOICES; i++)
+                for (int i = first; i < last; i++)
                     voices[i].env.decay(value);
                 break;
             case EncParam::ENV_SUS:
-                for (int i = 0; i < NUM_VOICES; i++)
+                for (int i = first; i < last; i++)
                     voices[i].env.sustain(value);
                 break;
             case EncParam::ENV_REL:
-                for (int i = 0; i < NUM_VOICES; i++)
+                for (int i = first; i < last; i++)
                     voices[i].env.release(value);
                 break;
             
@@ -295,6 +717,219 @@ namespace AudioEngine {
         }
     }
 
+    // ------------------ LOAD SHEDDING ------------------
+    // synthMax is polyphony per synth engine
+    void setVoiceLimit(uint8_t synthMax, uint8_t samplerMax) {
+        synthVoiceLimit   = constrain(synthMax, 1, VOICES_PER_ENGINE);
+        samplerVoiceLimit = constrain(samplerMax, 1, NUM_SAMPLER_VOICES);
+
+        // Release voices above the new limit so they stop costing CPU
+        for (int i = 0; i < NUM_VOICES; i++) {
+            if ((i % VOICES_PER_ENGINE) < synthVoiceLimit) continue;
+            Voice& voice = voices[i];
+            if (voice.active && trackVoiceMap[voice.trackId][voice.note] == i)
+                trackVoiceMap[voice.trackId][voice.note] = -1;
+            voice.env.noteOff();
+            voice.note   = 255;
+            voice.active = false;
+        }
+        for (int i = samplerVoiceLimit; i < NUM_SAMPLER_VOICES; i++) {
+            SamplerVoice &voice = samplerVoices[i];
+            if (voice.active && samplerTrackVoiceMap[voice.trackId][voice.note] == i)
+                samplerTrackVoiceMap[voice.trackId][voice.note] = -1;
+            voice.player.fadeOut();
+            voice.env.noteOff();
+            voice.active = false;
+        }
+    }
+
+    uint8_t getSynthVoiceLimit()   { return synthVoiceLimit; }
+    uint8_t getSamplerVoiceLimit() { return samplerVoiceLimit; }
+
+    // Bitcrusher passes blocks through untouched at 16 bit / full rate
+    void setFxBypass(bool bypass) {
+        if (bypass == fxBypassed) return;
+        fxBypassed = bypass;
+        for (int e = 0; e < MAX_ENGINES; e++) {
+            engines[e].crusher.bits(bypass ? 16 : crusherBits[e]);
+            engines[e].crusher.sampleRate(bypass ? AUDIO_SAMPLE_RATE : 16000);
+        }
+    }
+
+    bool isFxBypassed() { return fxBypassed; }
+
+    // ------------------ PATCH POOL ------------------
+    // Declared after the engines so the audio update order follows the signal flow
+    AudioMixer4             busMix[NUM_BUSES];      // engines -> bus
+    AudioMixer4             mixMain;                // buses -> output
+    AudioOutputI2S          i2s1;
+    AudioControlSGTL5000    sgtl5000_1;
+
+    static AudioConnection  cordPool[MAX_PATCH_CORDS];
+    static bool             cordUsed[MAX_PATCH_CORDS];
+
+    int16_t connectCord(AudioStream &src, uint8_t srcOut, AudioStream &dst, uint8_t dstIn) {
+        for (int16_t i = 0; i < MAX_PATCH_CORDS; i++) {
+            if (cordUsed[i]) continue;
+            if (cordPool[i].connect(src, srcOut, dst, dstIn) != 0) return -1;
+            cordUsed[i] = true;
+            return i;
+        }
+        Serial.println("Patch pool exhausted");
+        return -1;
+    }
+
+    void disconnectCord(int16_t cord) {
+        if (cord < 0 || cord >= MAX_PATCH_CORDS || !cordUsed[cord]) return;
+        cordPool[cord].disconnect();
+        cordUsed[cord] = false;
+    }
+
+    uint8_t freeCords() {
+        uint8_t n = 0;
+        for (int16_t i = 0; i < MAX_PATCH_CORDS; i++)
+            if (!cordUsed[i]) n++;
+        return n;
+    }
+
+    // ------------------ ROUTING ------------------
+    struct Route {
+        uint8_t bus;
+        uint8_t slot;           // busMix input
+        int16_t cord;
+    };
+
+    static Route   routes[NUM_ENGINE_IDS];
+    static uint8_t busSlotUsed[NUM_BUSES];   // bitmask of occupied busMix inputs
+
+    AudioStream& engineOutput(uint8_t engineId) {
+        if (engineId < MAX_ENGINES)      return engines[engineId].filter;
+        if (engineId == ENGINE_SAMPLER)  return mixSampler;
+        return metroEnv;
+    }
+
+    void releaseRoute(Route &r) {
+        disconnectCord(r.cord);
+        if (r.bus < NUM_BUSES) busSlotUsed[r.bus] &= ~(1 << r.slot);
+        r = { BUS_NONE, 0, -1 };
+    }
+
+    // Connects the new route before dropping the old one, both inside one
+    // audio-update-free window, so a rewire never drops or doubles a block.
+    bool routeEngine(uint8_t engineId, uint8_t busId) {
+        if (engineId >= NUM_ENGINE_IDS || busId >= NUM_BUSES) return false;
+        Route &r = routes[engineId];
+        if (r.bus == busId) return true;
+
+        uint8_t slot = 0;
+        while (slot < BUS_SLOTS && (busSlotUsed[busId] & (1 << slot))) slot++;
+        if (slot >= BUS_SLOTS) return false;   // bus full
+
+        AudioNoInterrupts();
+        int16_t cord = connectCord(engineOutput(engineId), 0, busMix[busId], slot);
+        if (cord >= 0) {
+            releaseRoute(r);
+            busSlotUsed[busId] |= (1 << slot);
+            r = { busId, slot, cord };
+        }
+        AudioInterrupts();
+        return cord >= 0;
+    }
+
+    void unrouteEngine(uint8_t engineId) {
+        if (engineId >= NUM_ENGINE_IDS) return;
+        AudioNoInterrupts();
+        releaseRoute(routes[engineId]);
+        AudioInterrupts();
+    }
+
+    uint8_t getEngineBus(uint8_t engineId) {
+        if (engineId >= NUM_ENGINE_IDS) return BUS_NONE;
+        return routes[engineId].bus;
+    }
+
+    void initRouting() {
+        for (uint8_t e = 0; e < NUM_ENGINE_IDS; e++)
+            routes[e] = { BUS_NONE, 0, -1 };
+        for (uint8_t b = 0; b < NUM_BUSES; b++) {
+            busSlotUsed[b] = 0;
+            for (uint8_t s = 0; s < BUS_SLOTS; s++)
+                busMix[b].gain(s, 1.0f);
+            connectCord(busMix[b], 0, mixMain, b);
+        }
+
+        connectCord(mixMain, 0, i2s1, 0);
+        connectCord(mixMain, 0, i2s1, 1);
+
+        for (uint8_t e = 0; e < MAX_ENGINES; e++)
+            routeEngine(ENGINE_SYNTH_0 + e, BUS_SYNTH);
+        routeEngine(ENGINE_SAMPLER, BUS_SAMPLER);
+        routeEngine(ENGINE_METRO,   BUS_METRO);
+    }
+
+    // ------------------ METERS ------------------
+    // Declared after the sources so a tap reads the current block
+    AudioAnalyzeLevel engineMeter[MAX_ENGINES];
+    AudioAnalyzeLevel samplerVoiceMeter[NUM_SAMPLER_VOICES];
+    AudioAnalyzeLevel masterMeter;
+
+    static LevelReading trackLevels[MAX_TRACKS];
+    static LevelReading masterLevel;
+    static const LevelReading silentLevel = { 0.0f, 0.0f, false };
+
+    void initMeters() {
+        for (uint8_t e = 0; e < MAX_ENGINES; e++)
+            connectCord(engineOutput(ENGINE_SYNTH_0 + e), 0, engineMeter[e], 0);
+        for (uint8_t v = 0; v < NUM_SAMPLER_VOICES; v++)
+            connectCord(samplerVoices[v].mixSample, 0, samplerVoiceMeter[v], 0);
+        connectCord(mixMain, 0, masterMeter, 0);
+    }
+
+    // Synth tracks read their engine, so tracks sharing an engine share a
+    // reading. Sampler tracks combine the voices they last triggered.
+    void readMeters() {
+        LevelReading eng[MAX_ENGINES];
+        LevelReading smp[NUM_SAMPLER_VOICES];
+        for (uint8_t e = 0; e < MAX_ENGINES; e++)        eng[e] = engineMeter[e].read();
+        for (uint8_t v = 0; v < NUM_SAMPLER_VOICES; v++) smp[v] = samplerVoiceMeter[v].read();
+
+        LevelReading m = masterMeter.read();
+        m.clip |= masterLevel.clip;
+        masterLevel = m;
+
+        for (uint8_t t = 0; t < MAX_TRACKS; t++) {
+            const Sequencer::Track &trk = Sequencer::curSeq().tracks[t];
+            LevelReading r = silentLevel;
+
+            if (trk.active && trk.type == (uint8_t)Sequencer::TrackType::SYNTH) {
+                if (trk.engine < MAX_ENGINES) r = eng[trk.engine];
+            } else if (trk.active && trk.type == (uint8_t)Sequencer::TrackType::SAMPLER) {
+                float power = 0.0f;
+                for (uint8_t v = 0; v < NUM_SAMPLER_VOICES; v++) {
+                    if (samplerVoices[v].trackId != t) continue;
+                    if (smp[v].peak > r.peak) r.peak = smp[v].peak;
+                    power  += smp[v].rms * smp[v].rms;
+                    r.clip |= smp[v].clip;
+                }
+                r.rms = sqrtf(power);
+            }
+            r.clip |= trackLevels[t].clip;
+            trackLevels[t] = r;
+        }
+    }
+
+    const LevelReading& getTrackLevel(uint8_t trackId) {
+        if (trackId >= MAX_TRACKS) return silentLevel;
+        return trackLevels[trackId];
+    }
+
+    const LevelReading& getMasterLevel() { return masterLevel; }
+
+    void clearClips() {
+        for (uint8_t t = 0; t < MAX_TRACKS; t++) trackLevels[t].clip = false;
+        masterLevel.clip = false;
+    }
+
     // ------------------ PENDING BUFFER ------------------
     volatile uint8_t pend_note[64];
     volatile uint8_t pend_vel[64];
@@ -325,7 +960,48 @@ namespace AudioEngine {
         return true;
     }
 
+    // ------------------ PARAMETER QUEUE ------------------
+    static volatile uint32_t paramTrackMask = 0;            // tracks with queued values
+    static volatile uint32_t paramMask[MAX_TRACKS];         // bit per EncParam
+    static volatile float    paramValue[MAX_TRACKS][PARAM_COUNT];
+
+    void queueParam(uint8_t trackId, EncParam id, float value) {
+        uint8_t p = (uint8_t)id;
+        if (trackId >= MAX_TRACKS || p >= PARAM_COUNT) return;
+        noInterrupts();
+        paramValue[trackId][p] = value;
+        paramMask[trackId] |= (1UL << p);
+        paramTrackMask |= (1UL << trackId);
+        interrupts();
+    }
+
+    // Values queued since the last pass collapse to one apply per parameter
+    static void applyQueuedParams() {
+        noInterrupts();
+        uint32_t tracks = paramTrackMask;
+        paramTrackMask = 0;
+        interrupts();
+
+        while (tracks) {
+            uint8_t t = __builtin_ctz(tracks);
+            tracks &= tracks - 1;
+
+            noInterrupts();
+            uint32_t mask = paramMask[t];
+            paramMask[t] = 0;
+            interrupts();
+
+            while (mask) {
+                uint8_t p = __builtin_ctz(mask);
+                mask &= mask - 1;
+                Params::applyValue(t, (EncParam)p, paramValue[t][p]);
+            }
+        }
+    }
+
     void processAudio() {
+        applyQueuedParams();    // before notes, so a lock is set when its note starts
+
         uint8_t trackId, note, vel;
         while (popPending(trackId, note, vel)) {
              Serial.printf("Pending note: track=%d pad=%d vel=%d\n", trackId, note, vel);
@@ -334,6 +1010,7 @@ namespace AudioEngine {
             else {trackNoteOff(trackId, note);}
 
         }
+        updateSamplerVoices();
     }
 
     // ------------------ INITIALIZATION ------------------
@@ -346,7 +1023,7 @@ namespace AudioEngine {
             }
         }
         // ------------ AUDIO MEMORY & BOARD ---------------
-        AudioMemory(160); 
+        AudioMemory(AUDIO_MEMORY_BLOCKS); 
         sgtl5000_1.enable(); 
         sgtl5000_1.volume(0.5f);
 
@@ -354,6 +1031,7 @@ namespace AudioEngine {
         mixMain.gain(0, 0.2f);              // synth
         mixMain.gain(1, 0.5f);              // sampler
         mixMain.gain(2, 0.4f);              // metro
+        mixMain.gain(3, 0.5f);              // aux
 
         // ------------------ METRO ------------------
         metroOsc.begin(WAVEFORM_SQUARE);
@@ -365,35 +1043,52 @@ namespace AudioEngine {
         metroEnv.decay(15);
         metroEnv.sustain(0);
         metroEnv.release(5);
+        connectCord(metroOsc, 0, metroEnv, 0);
 
         // ------------------ SAMPLER ENGINE ------------------
         initSamplerVoiceMap();
+        for (int t = 0; t < MAX_TRACKS; t++) {
+            clearKeymap(keymaps[t]);
+            samplerEnv[t] = defaultSamplerEnv;
+            lastTrackSample[t] = -1;
+        }
+        clearKeymap(padKeymap);
 
-        int pcsamp = 0;  // next free patchCords index
         for (int i = 0; i < NUM_SAMPLER_VOICES; i++) {
             SamplerVoice &voice = samplerVoices[i];
             voice.active = false;
+            voice.trackId = 0xFF;           // unowned until first trigger
+            voice.chokeGroup = 0;
+            voice.player.setInterpolation(samplerInterp);
             voice.mixSample.gain(0, 1.0f); // set mixer gain
             voice.mixSample.gain(1, 0.0f);
             voice.mixSample.gain(2, 0.0f);
             voice.mixSample.gain(3, 0.0f);
 
-            // Player -> per-voice mixer
-            patchCordsSampler[pcsamp++] = new AudioConnection(voice.player, 0, voice.mixSample, 0);
-            // Mixer -> main mix (use channel 0 so it goes to output)
-            patchCordsSampler[pcsamp++] = new AudioConnection(voice.mixSample, 0, mixMain, 1);
+            // Player -> envelope -> per-voice mixer -> sampler sum
+            connectCord(voice.player, 0, voice.env, 0);
+            connectCord(voice.env, 0, voice.mixSample, 0);
+            connectCord(voice.mixSample, 0, mixSampler, i);
+            mixSampler.gain(i, 1.0f);
         }
 
         // ------------------ SYNTH ENGINE ------------------
         initTrackVoiceMap();
 
-        engines[0].crusher.bits(24);
-        engines[0].crusher.sampleRate(16000);
-        engines[0].filter.frequency(3000);
-        engines[0].filter.resonance(0.1f);
+        for (int e = 0; e < MAX_ENGINES; e++) {
+            SynthEngine &eng = engines[e];
+            eng.crusher.bits(crusherBits[e]);
+            eng.crusher.sampleRate(16000);
+            eng.filter.frequency(3000);
+            eng.filter.resonance(0.1f);
+            for (int ch = 0; ch < VOICES_PER_ENGINE; ch++)
+                eng.mix.gain(ch, 1.0f);
+
+            connectCord(eng.mix, 0, eng.crusher, 0);
+            connectCord(eng.crusher, 0, eng.filter, 0);
+        }
 
         // ------------------ SYNTH VOICES ------------------
-        int pcsynth = 0;
         for (int i = 0; i < NUM_VOICES; i++) {
 
             Voice& voice = voices[i];
@@ -416,20 +1111,16 @@ namespace AudioEngine {
             voice.oscMix.gain(1, 0.5);
 
             // ------------------ PATCHING VOICE ------------------
-            patchCordsSynth[pcsynth++] = new AudioConnection(voice.oscA, 0, voice.oscMix, 0);
-            patchCordsSynth[pcsynth++] = new AudioConnection(voice.oscB, 0, voice.oscMix, 1);
-            patchCordsSynth[pcsynth++] = new AudioConnection(voice.oscMix, 0, voice.env, 0);
-            patchCordsSynth[pcsynth++] = new AudioConnection(voice.env, 0, engines[0].mix, i % 4);
+            connectCord(voice.oscA, 0, voice.oscMix, 0);
+            connectCord(voice.oscB, 0, voice.oscMix, 1);
+            connectCord(voice.oscMix, 0, voice.env, 0);
+            connectCord(voice.env, 0, engines[i / VOICES_PER_ENGINE].mix, i % VOICES_PER_ENGINE);
         }
 
-        // Engine FX → main mix
-        patchCordsSynth[pcsynth++] = new AudioConnection(engines[0].mix, 0, engines[0].crusher, 0);
-        patchCordsSynth[pcsynth++] = new AudioConnection(engines[0].crusher, 0, engines[0].filter, 0);
-        patchCordsSynth[pcsynth++] = new AudioConnection(engines[0].filter, 0, mixMain, 0);
-
-        patchCordsSynth[pcsynth++] = new AudioConnection(engines[1].mix, 0, engines[1].crusher, 0);
-        patchCordsSynth[pcsynth++] = new AudioConnection(engines[1].crusher, 0, engines[1].filter, 0);
-        patchCordsSynth[pcsynth++] = new AudioConnection(engines[1].filter, 0, mixMain, 1);
+        // ------------------ ROUTING ------------------
+        // Engine outputs -> buses -> main mix -> I2S
+        initRouting();
+        initMeters();
     }
 
 } // namespace AudioEngine
\ No newline at end of file
@@ -9,39 +9,118 @@
 #include <math.h>
 
 #include "Config.h"
+#include "AudioSampleVoice.h"
+#include "AudioAnalyzeLevel.h"
 
 namespace AudioEngine {
 
     #define SDCARD_CS_PIN    BUILTIN_SDCARD
+    #define AUDIO_MEMORY_BLOCKS 160
 
     // ------------------ SAMPLER ------------------
     #define NUM_SAMPLER_VOICES 4    // RAM-limited
-    #define MAX_SAMPLES 4          // SD sample pool
+    #define MAX_SAMPLES 64          // shared sample cache
+    #define MAX_SAMPLE_NAME 32
+    #define VOICE_CHOKE_SAMPLES 64  // fade of a choked or retriggered voice (~1.5 ms)
+    #define PEAK_LEVELS      4      // waveform overview resolutions
+    #define PEAK_BASE_FRAMES 64     // frames per peak at level 0, x4 per level
 
     struct SamplerVoice {
-        AudioPlaySdRaw      player;     // plays sample from RAM
+        AudioPlaySampleVoice player;    // plays sample from RAM
+        AudioEffectEnvelope env;        // per voice AHDSR
         AudioMixer4         mixSample;       // per voice mix
         uint8_t trackId; 
         uint8_t note;  
+        uint8_t chokeGroup;         // 0 = none
         bool active;           // pad/track mapping
         int sampleIndex;           // which sample is loaded
+        uint32_t startOrder;        // trigger count, oldest is stolen first
+    };
+
+    // Amplitude envelope per sampler track, times in ms
+    struct SamplerEnvelope {
+        float attack;
+        float hold;
+        float decay;
+        float sustain;              // 0..1
+        float release;
+    };
+
+    struct PeakPair {
+        int8_t min;                 // top 8 bits of the sample
+        int8_t max;
     };
 
     struct Sample {
-        const char* filename;       // SD filename
+        char     filename[MAX_SAMPLE_NAME];   // SD filename, "" = free slot
+        int16_t* data;              // cached frames (PSRAM), nullptr = not loaded
+        uint32_t length;            // frames
+        uint32_t start;             // playback region
+        uint32_t end;
+        uint32_t loopStart;
+        uint32_t loopEnd;           // 0 = one-shot
+        PeakPair* peaks[PEAK_LEVELS];       // min/max overview, built at load
+        uint32_t  peakCount[PEAK_LEVELS];
     };
 
+    inline uint32_t peakFrames(uint8_t level) { return (uint32_t)PEAK_BASE_FRAMES << (2 * level); }
+
     extern SamplerVoice samplerVoices[NUM_SAMPLER_VOICES];
     extern Sample samplePool[MAX_SAMPLES];
+
+    // ------------------ KEYMAP ------------------
+    #define MAX_KEYZONES 32         // zones per keymap
+    #define VEL_ZONES    16         // velocity resolution of the lookup table
+    #define NO_ZONE    0xFF
+
+    struct KeyZone {
+        uint8_t loKey, hiKey;
+        uint8_t loVel, hiVel;
+        uint8_t rootNote;           // note playing at original pitch
+        uint8_t sampleIdx;          // samplePool slot
+        uint8_t rrGroup;            // 0 = none, zones of one group alternate
+        uint8_t rrNext;             // next zone of the group (set by buildKeymap)
+        uint8_t chokeGroup;         // 0 = none, a trigger silences the track's group
+    };
+
+    struct Keymap {
+        KeyZone zones[MAX_KEYZONES];
+        uint8_t numZones;
+        uint8_t lut[128][VEL_ZONES];        // key x velocity zone -> zone index
+        uint8_t rrCursor[MAX_KEYZONES];     // per group head: zone to play next
+    };
+
+    // Tracks without zones fall back to the shared pad kit
+    extern Keymap keymaps[MAX_TRACKS];
+    extern Keymap padKeymap;
+
+    int8_t acquireSample(const char* filename);
+    void clearKeymap(Keymap &km);
+    int8_t addKeyZone(Keymap &km, const KeyZone &zone);
+    void buildKeymap(Keymap &km);
+    int8_t assignSampleZone(uint8_t trackId, const char* filename,
+                            uint8_t loKey, uint8_t hiKey, uint8_t rootNote,
+                            uint8_t loVel = 1, uint8_t hiVel = 127, uint8_t rrGroup = 0,
+                            uint8_t chokeGroup = 0);
+    const KeyZone* resolveZone(uint8_t trackId, uint8_t note, uint8_t vel);
     
     // Track→voice mapping
     extern int8_t samplerTrackVoiceMap[MAX_TRACKS][128];
 
     // ------------------ FUNCTIONS ------------------
     void loadAndAssignPad(const char* filename, uint8_t padId);
+    void setPadChokeGroup(uint8_t padId, uint8_t group);
     bool loadSample(int idx);
 
     int findFreeSamplerVoice();
+    int8_t lastSampleOnTrack(uint8_t trackId);
+    void chokeSamplerGroup(uint8_t trackId, uint8_t group);
+    void updateSamplerVoices();
+    void setSamplerEnvelope(uint8_t trackId, const SamplerEnvelope &env);
+    const SamplerEnvelope& getSamplerEnvelope(uint8_t trackId);
+    float samplerCpuUsage();
+    void setSamplerInterpolation(SampleInterp mode);
+    void benchmarkSampler();
 
     void samplerNoteOn(uint8_t trackId, uint8_t note, uint8_t vel);
     void samplerNoteOff(uint8_t trackId, uint8_t note);
@@ -71,11 +150,12 @@ namespace AudioEngine {
 
     extern uint8_t voiceNote[NUM_VOICES];
     float midiToFreq(uint8_t note);
-    int findFreeVoice();
+    int findFreeVoice(uint8_t engine);
     void noteOn(uint8_t trackId, uint8_t note, uint8_t vel);
     void noteOff(uint8_t trackId, uint8_t note);
     void muteTrack(uint8_t trackId);
     void allNotesOff();
+    float synthCpuUsage();
     
     // ------------------ ENGINES UNIFY ------------------
     void trackNoteOn(uint8_t trackId, uint8_t note, uint8_t vel);
@@ -83,9 +163,55 @@ namespace AudioEngine {
 
     // ------------------ AUDIO OBJECTS ------------------
     extern AudioMixer4             mixMain;
+
+    // ------------------ PATCH POOL ------------------
+    #define MAX_PATCH_CORDS 128     // static pool, no runtime allocation
+    #define BUS_SLOTS 4             // engines per bus (AudioMixer4 inputs)
+
+    enum EngineId : uint8_t {
+        ENGINE_SYNTH_0 = 0,         // synth engines 0..MAX_ENGINES-1
+        ENGINE_SAMPLER = MAX_ENGINES,
+        ENGINE_METRO,
+        NUM_ENGINE_IDS
+    };
+
+    enum BusId : uint8_t {
+        BUS_SYNTH = 0,              // bus id == mixMain input
+        BUS_SAMPLER,
+        BUS_METRO,
+        BUS_AUX,
+        NUM_BUSES,
+        BUS_NONE = 0xFF
+    };
+
+    int16_t connectCord(AudioStream &src, uint8_t srcOut, AudioStream &dst, uint8_t dstIn);
+    void disconnectCord(int16_t cord);
+    uint8_t freeCords();
+
+    // Routing table: engine output -> bus
+    bool routeEngine(uint8_t engineId, uint8_t busId);
+    void unrouteEngine(uint8_t engineId);
+    uint8_t getEngineBus(uint8_t engineId);
+    // ------------------ METERS ------------------
+    // Taps on each synth engine, each sampler voice and the main mix. A
+    // reading covers the window since the previous readMeters(); clip flags
+    // latch until clearClips().
+    void readMeters();              // call at the display meter rate
+    const LevelReading& getTrackLevel(uint8_t trackId);
+    const LevelReading& getMasterLevel();
+    void clearClips();
     // ------------------ PARAMETERS  ------------------
-    void setSynthParam(EncParam p, float value);
+    void setSynthParam(uint8_t trackId, EncParam p, float value);
     void setMainParam(EncParam param, float value);
+    // Written from the clock ISR by locks and lanes. processAudio applies
+    // only the latest value of each parameter, before that pass's notes.
+    void queueParam(uint8_t trackId, EncParam id, float value);
+    // ------------------ LOAD SHEDDING ------------------
+    void setVoiceLimit(uint8_t synthMax, uint8_t samplerMax);
+    uint8_t getSynthVoiceLimit();
+    uint8_t getSamplerVoiceLimit();
+    void setFxBypass(bool bypass);
+    bool isFxBypassed();
     // ------------------ PENDING BUFFER ------------------
     #define PEND_MASK 63
     extern volatile uint8_t pend_note[64];
@@ -0,0 +1,152 @@
+#include "AudioGovernor.h"
+#include "Display.h"
+
+namespace AudioGovernor {
+
+    static Budget budget;
+    static Stats  stats;
+    static bool   serialReport = false;
+    static uint8_t recoverCount = 0;
+
+    static elapsedMillis sampleTimer;
+    static elapsedMillis reportTimer;
+
+    static const char* shedLevelNames[SHED_LEVELS] = {
+        "NONE", "FX", "HALF", "MIN"
+    };
+
+    void setBudget(float cpuPercent, uint16_t memBlocks) {
+        budget.cpuPercent = constrain(cpuPercent, 10.0f, 100.0f);
+        budget.memBlocks  = constrain(memBlocks, 1, AUDIO_MEMORY_BLOCKS);
+    }
+
+    Budget getBudget() { return budget; }
+    const Stats& getStats() { return stats; }
+    void setSerialReport(bool on) { serialReport = on; }
+
+    // ------------------ SHEDDING ------------------
+    void applyShedLevel(uint8_t level) {
+        stats.shedLevel = level;
+
+        AudioEngine::setFxBypass(level >= SHED_FX);
+
+        switch (level) {
+            case SHED_NONE:
+            case SHED_FX:
+                AudioEngine::setVoiceLimit(VOICES_PER_ENGINE, NUM_SAMPLER_VOICES);
+                break;
+            case SHED_HALF_VOICES:
+                AudioEngine::setVoiceLimit(VOICES_PER_ENGINE / 2, NUM_SAMPLER_VOICES / 2);
+                break;
+            default:
+                AudioEngine::setVoiceLimit(GOV_MIN_SYNTH_VOICES, GOV_MIN_SAMPLER_VOICES);
+                break;
+        }
+        Serial.printf("Audio governor: shed level %s\n", shedLevelNames[level]);
+    }
+
+    // ------------------ MEASUREMENT ------------------
+    void sample() {
+        stats.cpu    = AudioProcessorUsage();
+        stats.cpuMax = AudioProcessorUsageMax();
+        stats.mem    = AudioMemoryUsage();
+        stats.memMax = AudioMemoryUsageMax();
+
+        stats.synthCpu   = AudioEngine::synthCpuUsage();
+        stats.samplerCpu = AudioEngine::samplerCpuUsage();
+        if (stats.synthCpu > stats.synthCpuMax)     stats.synthCpuMax = stats.synthCpu;
+        if (stats.samplerCpu > stats.samplerCpuMax) stats.samplerCpuMax = stats.samplerCpu;
+
+        // Max values are per window
+        AudioProcessorUsageMaxReset();
+        AudioMemoryUsageMaxReset();
+    }
+
+    void govern() {
+        bool over  = stats.cpuMax > budget.cpuPercent || stats.memMax > budget.memBlocks;
+        bool under = stats.cpuMax < budget.cpuPercent * 0.6f &&
+                     stats.memMax < budget.memBlocks * 6 / 10;
+
+        if (over) {
+            stats.overloads++;
+            recoverCount = 0;
+            if (stats.shedLevel < SHED_LEVELS - 1)
+                applyShedLevel(stats.shedLevel + 1);
+        }
+        else if (under && stats.shedLevel > SHED_NONE) {
+            // Hysteresis: only restore after a sustained quiet period
+            if (++recoverCount >= GOV_RECOVER_WINDOWS) {
+                recoverCount = 0;
+                applyShedLevel(stats.shedLevel - 1);
+            }
+        }
+        else {
+            recoverCount = 0;
+        }
+    }
+
+    // ------------------ REPORTING ------------------
+    void printStats(Print &out) {
+        out.printf("CPU %.1f%% (max %.1f / %.1f)  SYN %.1f%% (max %.1f)  SMP %.1f%% (max %.1f)  "
+                   "MEM %u (max %u / %u of %u)  SHED %s  OVL %lu\n",
+                   stats.cpu, stats.cpuMax, budget.cpuPercent,
+                   stats.synthCpu, stats.synthCpuMax,
+                   stats.samplerCpu, stats.samplerCpuMax,
+                   stats.mem, stats.memMax, budget.memBlocks, AUDIO_MEMORY_BLOCKS,
+                   shedLevelNames[stats.shedLevel], (unsigned long)stats.overloads);
+
+        Display::TxStats tx = Display::getTxStats();
+        out.printf("DISP %lu B/s  queued %u (max %u)  coalesced %lu  unchanged %lu  dropped %lu\n",
+                   (unsigned long)tx.bytesPerSec, tx.queued, tx.queuedMax,
+                   (unsigned long)tx.coalesced, (unsigned long)tx.unchanged,
+                   (unsigned long)tx.dropped);
+    }
+
+    void updateDiagPage() {
+        if (Display::getPage() != Display::PAGE_DIAG) return;
+
+        Display::writeNum("cpu.val",    (int32_t)stats.cpu);
+        Display::writeNum("cpumax.val", (int32_t)stats.cpuMax);
+        Display::writeNum("cpusyn.val", (int32_t)stats.synthCpu);
+        Display::writeNum("cpusmp.val", (int32_t)stats.samplerCpu);
+        Display::writeNum("mem.val",    stats.mem);
+        Display::writeNum("memmax.val", stats.memMax);
+        Display::writeNum("budget.val", (int32_t)budget.cpuPercent);
+        Display::writeStr("shed.txt",   shedLevelNames[stats.shedLevel]);
+        Display::writeNum("txbps.val",  Display::getTxStats().bytesPerSec);
+    }
+
+    // ------------------ PROCESS ------------------
+    void process() {
+        if (sampleTimer < GOV_SAMPLE_MS) return;
+        sampleTimer = 0;
+
+        sample();
+        govern();
+        updateDiagPage();
+
+        if (serialReport && reportTimer >= GOV_REPORT_MS) {
+            reportTimer = 0;
+            printStats(Serial);
+        }
+    }
+
+    // ------------------ INIT ------------------
+    void init(float cpuPercent, uint16_t memBlocks) {
+        setBudget(cpuPercent, memBlocks);
+        stats = {};
+        recoverCount = 0;
+        AudioProcessorUsageMaxReset();
+        AudioMemoryUsageMaxReset();
+        sampleTimer = 0;
+        reportTimer = 0;
+
+        // Live readings refresh at 4 Hz, peaks and budget on change
+        Display::setWidgetInterval("cpu.val",    250);
+        Display::setWidgetInterval("cpusyn.val", 250);
+        Display::setWidgetInterval("cpusmp.val", 250);
+        Display::setWidgetInterval("mem.val",    250);
+        Display::setWidgetInterval("txbps.val",  250);
+    }
+
+} // namespace AudioGovernor
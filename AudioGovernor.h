@@ -0,0 +1,55 @@
+#ifndef AUDIOGOVERNOR_H
+#define AUDIOGOVERNOR_H
+
+#include <Arduino.h>
+#include "AudioEngine.h"
+
+namespace AudioGovernor {
+
+    // ------------------ CONFIG ------------------
+    #define GOV_SAMPLE_MS       100     // measurement window
+    #define GOV_REPORT_MS      1000     // serial report interval
+    #define GOV_RECOVER_WINDOWS  20     // windows under budget before restoring a level
+    #define GOV_MIN_SYNTH_VOICES  1     // per engine
+    #define GOV_MIN_SAMPLER_VOICES 1
+
+    // Shed levels, applied cumulatively
+    enum ShedLevel : uint8_t {
+        SHED_NONE = 0,      // full polyphony, FX active
+        SHED_FX,            // bypass FX bus
+        SHED_HALF_VOICES,   // half polyphony
+        SHED_MIN_VOICES,    // minimum polyphony
+        SHED_LEVELS
+    };
+
+    struct Budget {
+        float    cpuPercent;    // AudioProcessorUsageMax() limit
+        uint16_t memBlocks;     // AudioMemoryUsageMax() limit
+    };
+
+    struct Stats {
+        float    cpu;           // total, current window
+        float    cpuMax;        // total, peak within window
+        float    synthCpu;      // synth engine objects
+        float    samplerCpu;    // sampler engine objects
+        float    synthCpuMax;
+        float    samplerCpuMax;
+        uint16_t mem;
+        uint16_t memMax;
+        uint8_t  shedLevel;
+        uint32_t overloads;     // windows that exceeded the budget
+    };
+
+    void init(float cpuPercent = 70.0f, uint16_t memBlocks = AUDIO_MEMORY_BLOCKS * 8 / 10);
+    void setBudget(float cpuPercent, uint16_t memBlocks);
+    Budget getBudget();
+    const Stats& getStats();
+
+    void setSerialReport(bool on);
+    void printStats(Print &out);
+
+    void process();     // call from loop()
+
+} // namespace AudioGovernor
+
+#endif
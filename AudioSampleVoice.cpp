@@ -0,0 +1,141 @@
+#include "AudioSampleVoice.h"
+
+// ------------------ RENDER ------------------
+static constexpr float PHASE_FRAC_SCALE = 1.0f / 4294967296.0f;
+
+// Frame read with loop wrap / region clamp, for interpolation taps only
+static inline float frameAt(const SampleVoiceState &v, int32_t i) {
+    if (v.loopEnd) {
+        if (i >= (int32_t)v.loopEnd) i = v.loopStart + (i - v.loopStart) % (v.loopEnd - v.loopStart);
+    } else if (i >= (int32_t)v.end) {
+        return 0.0f;
+    }
+    if (i < (int32_t)v.start) i = v.start;
+    return v.data[i];
+}
+
+bool renderSampleVoice(SampleVoiceState &v, int16_t* out, uint16_t n) {
+    uint16_t i = 0;
+
+    if (v.playing) {
+        const uint32_t stopFrame = v.loopEnd ? v.loopEnd : v.end;
+        const uint64_t loopBase  = (uint64_t)v.loopStart << 32;
+        const uint64_t loopLen   = (uint64_t)(v.loopEnd - v.loopStart) << 32;
+
+        for (; i < n; i++) {
+            uint32_t idx = v.phase >> 32;
+            if (idx >= stopFrame) {
+                if (!v.loopEnd) { v.playing = false; break; }
+                v.phase = loopBase + (v.phase - loopBase) % loopLen;     // rate may exceed the loop
+                idx = v.phase >> 32;
+            }
+
+            const float t  = (uint32_t)v.phase * PHASE_FRAC_SCALE;
+            const float x0 = v.data[idx];
+            const float x1 = frameAt(v, idx + 1);
+            float s;
+
+            if (v.interp == SampleInterp::CUBIC) {
+                // 4-point Catmull-Rom
+                const float xm1 = frameAt(v, (int32_t)idx - 1);
+                const float x2  = frameAt(v, idx + 2);
+                const float c1  = 0.5f * (x1 - xm1);
+                const float c2  = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+                const float c3  = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+                s = ((c3 * t + c2) * t + c1) * t + x0;
+            } else {
+                s = x0 + (x1 - x0) * t;
+            }
+
+            // De-click fades
+            if (v.fadeStep != 0.0f) {
+                v.fade += v.fadeStep;
+                if (v.fade >= 1.0f) {
+                    v.fade = 1.0f;
+                    v.fadeStep = 0.0f;
+                } else if (v.fade <= 0.0f) {
+                    v.playing = false;
+                    break;
+                }
+            }
+
+            int32_t o = (int32_t)(s * v.gain * v.fade);
+            if (o > 32767)       o = 32767;
+            else if (o < -32768) o = -32768;
+            out[i] = (int16_t)o;
+
+            v.phase += v.increment;
+        }
+    }
+
+    for (; i < n; i++) out[i] = 0;
+    return v.playing;
+}
+
+// ------------------ AUDIO OBJECT ------------------
+static inline uint64_t rateToIncrement(float rate) {
+    if (rate < 0.0f) rate = 0.0f;
+    return (uint64_t)((double)rate * 4294967296.0);
+}
+
+void AudioPlaySampleVoice::play(const int16_t* data, uint32_t start, uint32_t end,
+                                uint32_t loopStart, uint32_t loopEnd, float rate, float gain) {
+    if (!data || end <= start) return;
+
+    SampleVoiceState next;
+    next.data      = data;
+    next.start     = start;
+    next.end       = end;
+    bool loopValid = loopEnd > loopStart && loopStart >= start && loopEnd <= end;
+    next.loopStart = loopValid ? loopStart : 0;
+    next.loopEnd   = loopValid ? loopEnd : 0;
+    next.phase     = (uint64_t)start << 32;
+    next.increment = rateToIncrement(rate);
+    next.gain      = gain;
+    next.fade      = 0.0f;
+    next.fadeStep  = 1.0f / VOICE_FADE_IN_SAMPLES;
+    next.interp    = state.interp;
+    next.playing   = true;
+    next.releasing = false;
+
+    __disable_irq();
+    state = next;
+    __enable_irq();
+}
+
+void AudioPlaySampleVoice::setRate(float rate) {
+    uint64_t inc = rateToIncrement(rate);
+    __disable_irq();
+    state.increment = inc;
+    __enable_irq();
+}
+
+void AudioPlaySampleVoice::setGain(float gain) { state.gain = gain; }
+
+void AudioPlaySampleVoice::setInterpolation(SampleInterp mode) { state.interp = mode; }
+
+void AudioPlaySampleVoice::fadeOut(uint16_t fadeSamples) {
+    if (fadeSamples == 0) fadeSamples = 1;
+    __disable_irq();
+    if (state.playing && !state.releasing) {
+        state.releasing = true;
+        state.fadeStep  = -state.fade / fadeSamples;
+        if (state.fadeStep == 0.0f) state.playing = false;
+    }
+    __enable_irq();
+}
+
+void AudioPlaySampleVoice::stop() {
+    state.playing = false;
+}
+
+void AudioPlaySampleVoice::update(void) {
+    if (!state.playing) return;
+
+    audio_block_t *block = allocate();
+    if (!block) return;
+
+    renderSampleVoice(state, block->data, AUDIO_BLOCK_SAMPLES);
+    transmit(block);
+    AudioStream::release(block);
+}
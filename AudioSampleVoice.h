@@ -0,0 +1,59 @@
+#ifndef AUDIOSAMPLEVOICE_H
+#define AUDIOSAMPLEVOICE_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+// ------------------ CONFIG ------------------
+#define VOICE_FADE_IN_SAMPLES    32     // de-click ramp on start
+#define VOICE_FADE_OUT_SAMPLES  256     // de-click ramp on release (~6 ms)
+
+enum class SampleInterp : uint8_t {
+    LINEAR,
+    CUBIC
+};
+
+// Render state of one voice, kept separate from the AudioStream so the
+// inner loop can be run (and timed) outside the audio graph.
+struct SampleVoiceState {
+    const int16_t* data = nullptr;
+    uint32_t start      = 0;        // first frame
+    uint32_t end        = 0;        // one past the last frame
+    uint32_t loopStart  = 0;
+    uint32_t loopEnd    = 0;        // 0 = one-shot
+    uint64_t phase      = 0;        // Q32.32 frame position
+    uint64_t increment  = 0;        // Q32.32 frames per output sample
+    float    gain       = 1.0f;
+    float    fade       = 0.0f;     // current fade multiplier
+    float    fadeStep   = 0.0f;     // per sample, + fade in / - fade out
+    SampleInterp interp = SampleInterp::LINEAR;
+    bool     playing    = false;
+    bool     releasing  = false;
+};
+
+// Renders n samples; returns false once the voice has finished
+bool renderSampleVoice(SampleVoiceState &v, int16_t* out, uint16_t n);
+
+class AudioPlaySampleVoice : public AudioStream {
+public:
+    AudioPlaySampleVoice() : AudioStream(0, nullptr) {}
+
+    // rate = playback frames per output sample (1.0 = original pitch)
+    void play(const int16_t* data, uint32_t start, uint32_t end,
+              uint32_t loopStart, uint32_t loopEnd, float rate, float gain);
+    void setRate(float rate);
+    void setGain(float gain);
+    void setInterpolation(SampleInterp mode);
+    void fadeOut(uint16_t fadeSamples = VOICE_FADE_OUT_SAMPLES);
+    void stop();
+
+    bool isPlaying() { return state.playing; }
+    bool isFading()  { return state.playing && state.releasing; }
+
+    virtual void update(void);
+
+private:
+    SampleVoiceState state;
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "Automation.h"
+#include "AudioEngine.h"
+#include "Params.h"
+#include "PatternEdit.h"
+
+namespace Automation {
+
+    static uint8_t  laneTarget[MAX_TRACKS][MOD_LANES];     // EncParam or LANE_NONE
+    static uint8_t  laneValue[MAX_TRACKS][MOD_LANES];      // last point played, LANE_NONE = none
+    static volatile uint32_t lockedMask[MAX_TRACKS];       // params locked on the current step
+
+    void init() {
+        memset(laneTarget, LANE_NONE, sizeof(laneTarget));
+        memset(laneValue,  LANE_NONE, sizeof(laneValue));
+        memset((void*)lockedMask, 0, sizeof(lockedMask));
+    }
+
+    // ------------------ EDITING ------------------
+    // Index of the CC event at tick with the given note, or -1
+    static int32_t findControl(const Sequencer::Pattern &p, uint32_t tick, uint8_t note) {
+        for (uint16_t i = Sequencer::lowerBound(p, tick); i < p.count && p.events[i].tick == tick; i++) {
+            const Sequencer::Event &e = p.events[i];
+            if (e.type == Sequencer::EventType::CC && e.note == note) return i;
+        }
+        return -1;
+    }
+
+    static bool putControl(uint8_t trackId, uint16_t step, uint8_t note, uint8_t value) {
+        if (trackId >= MAX_TRACKS || step >= Sequencer::getTotalSteps()) return false;
+        Sequencer::Track &tr = Sequencer::curSeq().tracks[trackId];
+        if (!tr.pattern.events) Sequencer::initPattern(tr);
+
+        uint32_t tick = (uint32_t)step * TICKS_PER_STEP;
+        bool ok = true;
+        PatternEdit::begin();
+        noInterrupts();
+        int32_t i = findControl(tr.pattern, tick, note);
+        if (i >= 0) {
+            PatternEdit::logModify(tr.pattern, i, tr.pattern.events[i]);
+            tr.pattern.events[i].value = value;
+        }
+        interrupts();
+        if (i < 0) {
+            Sequencer::Event e = { tick, Sequencer::EventType::CC, note, value };
+            ok = Sequencer::insertEvent(tr.pattern, e);
+        }
+        PatternEdit::end();
+        if (ok) Sequencer::markTrackEdited(trackId);
+        return ok;
+    }
+
+    static bool dropControl(uint8_t trackId, uint16_t step, uint8_t note) {
+        if (trackId >= MAX_TRACKS) return false;
+        Sequencer::Pattern &p = Sequencer::curSeq().tracks[trackId].pattern;
+        if (!p.events) return false;
+        int32_t i = findControl(p, (uint32_t)step * TICKS_PER_STEP, note);
+        if (i < 0) return false;
+        PatternEdit::begin();
+        Sequencer::removeEvent(p, i);
+        PatternEdit::end();
+        Sequencer::markTrackEdited(trackId);
+        return true;
+    }
+
+    bool setLock(uint8_t trackId, uint16_t step, EncParam id, float value) {
+        if ((uint8_t)id >= PARAM_COUNT) return false;
+        return putControl(trackId, step, LOCK_FLAG | (uint8_t)id, Params::toNormalized(id, value));
+    }
+
+    bool clearLock(uint8_t trackId, uint16_t step, EncParam id) {
+        return dropControl(trackId, step, LOCK_FLAG | (uint8_t)id);
+    }
+
+    void setLaneTarget(uint8_t trackId, uint8_t lane, EncParam id) {
+        if (trackId >= MAX_TRACKS || lane >= MOD_LANES || (uint8_t)id >= PARAM_COUNT) return;
+        noInterrupts();
+        laneTarget[trackId][lane] = (uint8_t)id;
+        laneValue[trackId][lane]  = LANE_NONE;
+        interrupts();
+    }
+
+    void clearLane(uint8_t trackId, uint8_t lane) {
+        if (trackId >= MAX_TRACKS || lane >= MOD_LANES) return;
+        noInterrupts();
+        laneTarget[trackId][lane] = LANE_NONE;
+        laneValue[trackId][lane]  = LANE_NONE;
+        interrupts();
+
+        Sequencer::Pattern &p = Sequencer::curSeq().tracks[trackId].pattern;
+        PatternEdit::begin();
+        for (int32_t i = (int32_t)p.count - 1; i >= 0; i--) {
+            if (p.events[i].type == Sequencer::EventType::CC && p.events[i].note == lane)
+                Sequencer::removeEvent(p, i);
+        }
+        PatternEdit::end();
+        Sequencer::markTrackEdited(trackId);
+    }
+
+    bool setLanePoint(uint8_t trackId, uint8_t lane, uint16_t step, uint8_t value) {
+        if (lane >= MOD_LANES) return false;
+        return putControl(trackId, step, lane, min(value, (uint8_t)127));
+    }
+
+    // ------------------ PLAYBACK ------------------
+    // Value a parameter returns to when nothing locks it: its lane if one
+    // has played a point, else the stored track value
+    static float baseValue(uint8_t trackId, uint8_t param) {
+        for (uint8_t l = 0; l < MOD_LANES; l++) {
+            if (laneTarget[trackId][l] == param && laneValue[trackId][l] != LANE_NONE)
+                return Params::fromNormalized((EncParam)param, laneValue[trackId][l]);
+        }
+        return Params::get(trackId, (EncParam)param);
+    }
+
+    void onStepStart(uint8_t trackId) {
+        uint32_t mask = lockedMask[trackId];
+        if (!mask) return;
+        lockedMask[trackId] = 0;
+        while (mask) {
+            uint8_t p = __builtin_ctz(mask);
+            mask &= mask - 1;
+            AudioEngine::queueParam(trackId, (EncParam)p, baseValue(trackId, p));
+        }
+    }
+
+    void onControlEvent(uint8_t trackId, const Sequencer::Event &e) {
+        if (e.note & LOCK_FLAG) {
+            uint8_t p = e.note & ~LOCK_FLAG;
+            if (p >= PARAM_COUNT) return;
+            lockedMask[trackId] |= (1UL << p);
+            AudioEngine::queueParam(trackId, (EncParam)p, Params::fromNormalized((EncParam)p, e.value));
+            return;
+        }
+
+        if (e.note >= MOD_LANES) return;
+        uint8_t p = laneTarget[trackId][e.note];
+        if (p == LANE_NONE) return;
+        laneValue[trackId][e.note] = e.value;
+        if (lockedMask[trackId] & (1UL << p)) return;     // a lock wins for this step
+        AudioEngine::queueParam(trackId, (EncParam)p, Params::fromNormalized((EncParam)p, e.value));
+    }
+
+    // Takes the locked and lane-driven params of each track in one critical
+    // section, then queues their stored values outside it, since queueParam
+    // has its own
+    void releaseLocks() {
+        for (uint8_t t = 0; t < MAX_TRACKS; t++) {
+            noInterrupts();
+            uint32_t mask = lockedMask[t];
+            lockedMask[t] = 0;
+            for (uint8_t l = 0; l < MOD_LANES; l++) {
+                if (laneTarget[t][l] != LANE_NONE && laneValue[t][l] != LANE_NONE)
+                    mask |= (1UL << laneTarget[t][l]);
+                laneValue[t][l] = LANE_NONE;
+            }
+            interrupts();
+
+            while (mask) {
+                uint8_t p = __builtin_ctz(mask);
+                mask &= mask - 1;
+                AudioEngine::queueParam(t, (EncParam)p, Params::get(t, (EncParam)p));
+            }
+        }
+    }
+
+} // namespace Automation
@@ -0,0 +1,35 @@
+#ifndef AUTOMATION_H
+#define AUTOMATION_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Sequencer.h"
+
+namespace Automation {
+
+    // ------------------ CONFIG ------------------
+    #define MOD_LANES  4            // per track
+    #define LOCK_FLAG  0x80         // CC note: LOCK_FLAG | param id, else lane index
+    #define LANE_NONE  0xFF
+
+    void init();
+
+    // Parameter locks and lane points are CC events in the track's pattern,
+    // so they share its storage, ordering, clearing and play cursor. The
+    // event value is 0..127 across the parameter's range.
+    bool setLock(uint8_t trackId, uint16_t step, EncParam id, float value);
+    bool clearLock(uint8_t trackId, uint16_t step, EncParam id);
+
+    void setLaneTarget(uint8_t trackId, uint8_t lane, EncParam id);
+    void clearLane(uint8_t trackId, uint8_t lane);      // target and points
+    bool setLanePoint(uint8_t trackId, uint8_t lane, uint16_t step, uint8_t value);
+
+    // Clock ISR side. Each call costs the locks set on the previous step or
+    // the one event played, never the number of locks in the pattern.
+    void onStepStart(uint8_t trackId);
+    void onControlEvent(uint8_t trackId, const Sequencer::Event &e);
+    void releaseLocks();            // all tracks back to their stored values
+
+} // namespace Automation
+
+#endif
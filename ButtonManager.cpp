@@ -20,6 +20,10 @@ void Mux16::select(uint8_t ch) {
     digitalWrite(S3, (ch >> 3) & 1);
 }
 
+uint8_t Mux16::readSelected() {
+    return digitalRead(SIG);
+}
+
 uint8_t Mux16::readChannel(uint8_t ch) {
     select(ch);
     delayMicroseconds(5); // tiny settling time
@@ -31,18 +35,22 @@ uint8_t Mux16::readChannel(uint8_t ch) {
 ButtonManager* ButtonManager::instance = nullptr;
 IntervalTimer ButtonManager::scanTimer;
 
-ButtonManager::ButtonManager(uint16_t debounce)
-    : numButtons(0), debounceMs(debounce) {}
+ButtonManager::ButtonManager(uint16_t tickUs)
+    : numButtons(0), scanCursor(0), scanTickUs(tickUs), edgeHandler(nullptr) {}
+
+void ButtonManager::setEdgeHandler(BtnEdgeHandler handler) { edgeHandler = handler; }
 
 void ButtonManager::begin() {
     for (uint8_t i = 0; i < numButtons; i++) {
         ButtonEntry &b = buttons[i];
-        b.stableState = b.lastState = b.isMux ? b.mux->readChannel(b.channel) : digitalRead(b.pin);
-        b.lastChange = millis();
+        b.stableState = b.isMux ? b.mux->readChannel(b.channel) : digitalRead(b.pin);
+        b.history = b.stableState ? BTN_DEBOUNCE_MASK : 0;
     }
+    scanCursor = 0;
+    if (numButtons && buttons[0].isMux) buttons[0].mux->select(buttons[0].channel);
 
     instance = this;
-    scanTimer.begin(scanISR, 1000); // 1 kHz
+    scanTimer.begin(scanISR, scanTickUs);
 }
 
 
@@ -51,7 +59,7 @@ uint8_t ButtonManager::addMuxButton(Mux16* mux, uint8_t channel,
                                     bool pressOnly) {
     if (numButtons >= MAX_BUTTONS) return 255;
 
-    buttons[numButtons++] = {
+    buttons[numButtons] = {
         true,         // isMux
         mux,
         channel,
@@ -59,12 +67,11 @@ uint8_t ButtonManager::addMuxButton(Mux16* mux, uint8_t channel,
         cbPress,      // press callback
         cbRelease,    // release callback
         pressOnly,
-        1, 1,
-        millis(),
-        debounceMs
+        1,            // released (active-low)
+        BTN_DEBOUNCE_MASK
     };
 
-    return numButtons - 1;
+    return numButtons++;        // publish to the ISR once filled in
 }
 
 uint8_t ButtonManager::addDirectButton(uint8_t pin, 
@@ -74,7 +81,7 @@ uint8_t ButtonManager::addDirectButton(uint8_t pin,
 
     pinMode(pin, INPUT_PULLUP);
 
-    buttons[numButtons++] = {
+    buttons[numButtons] = {
         false,        // isMux
         nullptr,
         0,
@@ -82,12 +89,11 @@ uint8_t ButtonManager::addDirectButton(uint8_t pin,
         cbPress,      // press callback
         cbRelease,    // release callback
         pressOnly,
-        1, 1,
-        millis(),
-        debounceMs
+        1,            // released (active-low)
+        BTN_DEBOUNCE_MASK
     };
 
-    return numButtons - 1;
+    return numButtons++;        // publish to the ISR once filled in
 }
 
 //-------------------- ISR --------------------
@@ -99,34 +105,52 @@ void ButtonManager::scanISR() {
 
 //-------------------- Scan Routine --------------------
 
+// Pipelined: the mux channel selected on the previous tick has had a whole
+// tick to settle, so it is read without waiting and the next one selected.
 void ButtonManager::scanButtons() {
-    unsigned long now = millis();
+    uint8_t count = numButtons;
+    if (!count) return;
+    if (scanCursor >= count) scanCursor = 0;
 
-    for (uint8_t i = 0; i < numButtons; i++) {
-        ButtonEntry* b = &buttons[i];
-        uint8_t raw = b->isMux ? b->mux->readChannel(b->channel) : digitalRead(b->pin);
+    ButtonEntry &b = buttons[scanCursor];
+    sampleButton(scanCursor, b.isMux ? b.mux->readSelected() : digitalRead(b.pin));
 
-        // Debounce
-        if (raw != b->lastState) {
-            b->lastChange = now;
-            b->lastState = raw;
-        }
-        if ((now - b->lastChange) >= b->debounceMs) {
-            if (raw != b->stableState) {
-                b->stableState = raw;
-
-                // Trigger press/release callbacks
-                if (b->triggerOnPress) {
-                    if (!b->stableState && b->callbackPress) {   // pressed (active-low)
-                        b->callbackPress();
-                    } else if (b->stableState && b->callbackRelease) { // released
-                        b->callbackRelease();
-                    }
-                } else {
-                    // level-sensitive
-                    if (b->callbackPress) b->callbackPress();
-                }
-            }
+    scanCursor = (scanCursor + 1 < count) ? scanCursor + 1 : 0;
+    ButtonEntry &next = buttons[scanCursor];
+    if (next.isMux) next.mux->select(next.channel);
+}
+
+// Shift-register integrator: the state changes only after eight equal
+// samples in a row, so a bouncing contact never produces an edge.
+void ButtonManager::sampleButton(uint8_t id, uint8_t raw) {
+    ButtonEntry &b = buttons[id];
+    b.history = (b.history << 1) | (raw ? 1 : 0);
+
+    uint8_t level;
+    if (b.history == BTN_DEBOUNCE_MASK) level = 1;
+    else if (b.history == 0)            level = 0;
+    else return;
+
+    if (level == b.stableState) return;
+    b.stableState = level;
+
+    if (edgeHandler) edgeHandler(id, !level);   // pressed = active-low
+    else             dispatch(id, !level);
+}
+
+void ButtonManager::dispatch(uint8_t id, bool pressed) {
+    if (id >= numButtons) return;
+    ButtonEntry &b = buttons[id];
+
+    // Trigger press/release callbacks
+    if (b.triggerOnPress) {
+        if (pressed && b.callbackPress) {
+            b.callbackPress();
+        } else if (!pressed && b.callbackRelease) {
+            b.callbackRelease();
         }
+    } else {
+        // level-sensitive
+        if (b.callbackPress) b.callbackPress();
     }
 }
@@ -4,13 +4,17 @@
 #include <Arduino.h>
 #include <IntervalTimer.h>
 
+#define BTN_SCAN_TICK_US   100   // one button sampled per tick
+#define BTN_DEBOUNCE_MASK 0xFF   // 8 equal samples make a stable state
+
 class Mux16 {
 public:
     Mux16(uint8_t s0, uint8_t s1, uint8_t s2, uint8_t s3, uint8_t sig);
 
     void begin();
     void select(uint8_t ch);
-    uint8_t readChannel(uint8_t ch);
+    uint8_t readSelected();             // SIG of the channel selected earlier
+    uint8_t readChannel(uint8_t ch);    // select, settle and read (blocking)
 
 private:
     uint8_t S0, S1, S2, S3, SIG;
@@ -19,6 +23,10 @@ private:
 // Callback type for buttons
 typedef void (*BtnCallback)();
 
+// Edge hook, called from the scan ISR in place of the callbacks. The
+// receiver queues the edge and runs dispatch() later from loop().
+typedef void (*BtnEdgeHandler)(uint8_t id, bool pressed);
+
 class ButtonManager {
 public:
     struct ButtonEntry {
@@ -30,12 +38,11 @@ public:
         BtnCallback callbackRelease;
         bool triggerOnPress;      // true = trigger only on press, false = level-sensitive
         uint8_t stableState;      // last stable state
-        uint8_t lastState;        // last raw state
-        unsigned long lastChange; // last change timestamp
-        uint16_t debounceMs;
+        uint8_t history;          // raw samples, newest in bit 0
     };
 
-    ButtonManager(uint16_t debounce = 10);
+    // Debounce time is 8 samples, one sweep over all buttons apart
+    ButtonManager(uint16_t scanTickUs = BTN_SCAN_TICK_US);
 
     uint8_t addMuxButton(Mux16* mux, uint8_t channel, BtnCallback cbPress, BtnCallback cbRelease = nullptr, bool pressOnly = true);
 
@@ -43,17 +50,23 @@ public:
 
     void begin();
 
+    void setEdgeHandler(BtnEdgeHandler handler);
+    void dispatch(uint8_t id, bool pressed);   // runs the button's callbacks
+
 private:
     static const uint8_t MAX_BUTTONS = 32;
     ButtonEntry buttons[MAX_BUTTONS];
-    uint8_t numButtons;
-    uint16_t debounceMs;
+    volatile uint8_t numButtons;
+    uint8_t scanCursor;              // button sampled on the next tick
+    uint16_t scanTickUs;
+    BtnEdgeHandler edgeHandler;
 
     static ButtonManager* instance;  // ISR reference
     static IntervalTimer scanTimer;
-    static void scanISR();           // ISR runs at 1 kHz
+    static void scanISR();
 
-    void scanButtons();              // real scan routine
+    void scanButtons();              // samples one button, selects the next
+    void sampleButton(uint8_t id, uint8_t raw);
 };
 
 #endif
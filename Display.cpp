@@ -3,35 +3,464 @@
 namespace Display {
 
     static EasyNex* displayInstance = nullptr;
+    static HardwareSerial* port = nullptr;
+    static uint8_t currentPage = PAGE_LOAD;
 
+    // ------------------ TX QUEUE ------------------
+    // Commands are queued as complete frames (text + FF FF FF) and pump()
+    // hands them to the UART only as fast as its buffer accepts them, so
+    // a large redraw never stalls loop().
+    #define TX_MASK (DISPLAY_TX_RING - 1)
+
+    DMAMEM static uint8_t txRing[DISPLAY_TX_RING];
+    static uint8_t serialTxBuffer[DISPLAY_TX_SERIAL];
+    static volatile uint16_t txHead = 0;    // written by producers
+    static volatile uint16_t txTail = 0;    // written by pump() only
+
+    static TxStats txStats = {};
+    static uint32_t bytesThisSecond = 0;
+    static elapsedMillis statsTimer;
+
+    // Pending writes keyed by object name. A later write to the same object
+    // replaces the queued value, so only the last value of a frame is sent.
+    struct Slot {
+        char obj[DISPLAY_OBJ_LEN];
+        char value[DISPLAY_VAL_LEN];
+        bool isStr;
+    };
+
+    static Slot slots[DISPLAY_SLOTS];
+    static uint8_t numSlots = 0;
+
+    static inline uint16_t txUsed() {
+        return (txHead - txTail) & TX_MASK;
+    }
+
+    // Caller holds interrupts off
+    static bool enqueue(const char* text, uint16_t len) {
+        if (len + 3 > DISPLAY_TX_RING - 1 - txUsed()) {
+            txStats.dropped++;
+            return false;
+        }
+        uint16_t h = txHead;
+        for (uint16_t i = 0; i < len; i++) {
+            txRing[h] = text[i];
+            h = (h + 1) & TX_MASK;
+        }
+        for (uint8_t i = 0; i < 3; i++) {
+            txRing[h] = 0xFF;
+            h = (h + 1) & TX_MASK;
+        }
+        txHead = h;
+
+        uint16_t used = txUsed();
+        if (used > txStats.queuedMax) txStats.queuedMax = used;
+        return true;
+    }
+
+    static bool enqueueAssign(const char* obj, const char* value, bool isStr) {
+        char cmd[DISPLAY_OBJ_LEN + DISPLAY_VAL_LEN + 4];
+        uint16_t objLen = strnlen(obj, DISPLAY_OBJ_LEN - 1);
+        uint16_t valLen = strnlen(value, DISPLAY_VAL_LEN - 1);
+        uint16_t len = 0;
+
+        memcpy(cmd, obj, objLen);
+        len += objLen;
+        cmd[len++] = '=';
+        if (isStr) cmd[len++] = '"';
+        memcpy(cmd + len, value, valLen);
+        len += valLen;
+        if (isStr) cmd[len++] = '"';
+        return enqueue(cmd, len);
+    }
+
+    // Moves the pending table into the ring, keeping first-write order
+    static void flushSlots() {
+        for (uint8_t i = 0; i < numSlots; i++)
+            enqueueAssign(slots[i].obj, slots[i].value, slots[i].isStr);
+        numSlots = 0;
+    }
+
+    static void queueAssign(const char* obj, const char* value, bool isStr) {
+        noInterrupts();
+        for (uint8_t i = 0; i < numSlots; i++) {
+            Slot &s = slots[i];
+            if (s.isStr != isStr || strcmp(s.obj, obj) != 0) continue;
+            strncpy(s.value, value, DISPLAY_VAL_LEN - 1);
+            s.value[DISPLAY_VAL_LEN - 1] = 0;
+            txStats.coalesced++;
+            interrupts();
+            return;
+        }
+
+        if (numSlots < DISPLAY_SLOTS &&
+            strlen(obj) < DISPLAY_OBJ_LEN && strlen(value) < DISPLAY_VAL_LEN) {
+            Slot &s = slots[numSlots++];
+            strcpy(s.obj, obj);
+            strcpy(s.value, value);
+            s.isStr = isStr;
+        } else {
+            flushSlots();
+            enqueueAssign(obj, value, isStr);
+        }
+        interrupts();
+    }
+
+    // ------------------ WIDGETS ------------------
+    struct Widget {
+        uint32_t hash;                      // of obj, checked before strcmp
+        char     obj[DISPLAY_OBJ_LEN];
+        char     sent[DISPLAY_VAL_LEN];     // value the display shows
+        char     pending[DISPLAY_VAL_LEN];  // held back by the interval
+        uint32_t lastSent;
+        uint16_t minInterval;
+        bool     isStr;
+        bool     valid;                     // sent matches the display
+        bool     hasPending;
+    };
+
+    static Widget widgets[DISPLAY_WIDGETS];
+    static uint8_t numWidgets = 0;
+
+    static uint32_t hashName(const char* s) {
+        uint32_t h = 2166136261u;           // FNV-1a
+        while (*s) h = (h ^ (uint8_t)*s++) * 16777619u;
+        return h;
+    }
+
+    static Widget* findWidget(const char* obj, bool create) {
+        uint32_t h = hashName(obj);
+        for (uint8_t i = 0; i < numWidgets; i++) {
+            if (widgets[i].hash == h && strcmp(widgets[i].obj, obj) == 0) return &widgets[i];
+        }
+        if (!create || numWidgets >= DISPLAY_WIDGETS || strlen(obj) >= DISPLAY_OBJ_LEN) return nullptr;
+
+        Widget &w = widgets[numWidgets++];
+        memset(&w, 0, sizeof(w));
+        w.hash = h;
+        strcpy(w.obj, obj);
+        return &w;
+    }
+
+    // Widgets coalesce themselves, so they go straight to the ring, after
+    // the slots to keep write order. The widget only counts as sent once
+    // its bytes are queued; a dropped write stays pending for pump().
+    static void sendWidget(Widget &w, const char* value) {
+        noInterrupts();
+        flushSlots();
+        bool queued = enqueueAssign(w.obj, value, w.isStr);
+        interrupts();
+
+        if (!queued) {
+            if (value != w.pending) strcpy(w.pending, value);
+            w.hasPending = true;
+            return;
+        }
+        strcpy(w.sent, value);
+        w.valid      = true;
+        w.hasPending = false;
+        w.lastSent   = millis();
+    }
+
+    static void writeWidget(const char* obj, const char* value, bool isStr) {
+        Widget* w = (strlen(value) < DISPLAY_VAL_LEN) ? findWidget(obj, true) : nullptr;
+        if (!w) {
+            queueAssign(obj, value, isStr);     // table full or value too long
+            return;
+        }
+
+        if (w->valid && w->isStr == isStr && strcmp(w->sent, value) == 0) {
+            w->hasPending = false;              // a held change was undone
+            txStats.unchanged++;
+            return;
+        }
+        w->isStr = isStr;
+
+        if (w->valid && millis() - w->lastSent < w->minInterval) {
+            strcpy(w->pending, value);
+            w->hasPending = true;
+            return;
+        }
+        sendWidget(*w, value);
+    }
+
+    static void flushWidgets() {
+        uint32_t now = millis();
+        for (uint8_t i = 0; i < numWidgets; i++) {
+            Widget &w = widgets[i];
+            if (w.hasPending && now - w.lastSent >= w.minInterval)
+                sendWidget(w, w.pending);
+        }
+    }
+
+    void setWidgetInterval(const char* obj, uint16_t minIntervalMs) {
+        Widget* w = findWidget(obj, true);
+        if (w) w->minInterval = minIntervalMs;
+    }
+
+    void invalidateWidgets() {
+        for (uint8_t i = 0; i < numWidgets; i++) {
+            widgets[i].valid      = false;
+            widgets[i].hasPending = false;
+        }
+    }
+
+    // ------------------ RX PARSER ------------------
+    // Fixed-size frames are read by length because their payload may
+    // contain 0xFF; other frames end at the first FF FF FF.
+    #define RX_FRAME_MAX (DISPLAY_RX_TEXT + 1)
+
+    static uint8_t serialRxBuffer[DISPLAY_RX_SERIAL];
+    static RxHandler rxHandler = nullptr;
+    static RxStats rxStats = {};
+
+    static uint8_t rxFrame[RX_FRAME_MAX];
+    static uint8_t rxLen    = 0;
+    static uint8_t rxFF     = 0;            // terminator bytes seen
+    static uint8_t rxExpect = 0;            // payload length, 0 = variable
+    static bool    rxOverflow = false;
+
+    static uint8_t rxFrameLength(uint8_t header) {
+        switch (header) {
+            case 0x65: return 4;            // touch: page, component, event
+            case 0x66: return 2;            // page
+            case 0x67:
+            case 0x68: return 6;            // touch coordinates (ignored)
+            case 0x71: return 5;            // number, little endian
+            default:   return 0;
+        }
+    }
+
+    static void rxStore(uint8_t b) {
+        if (rxLen < RX_FRAME_MAX) rxFrame[rxLen++] = b;
+        else rxOverflow = true;
+    }
+
+    static void rxReset() {
+        rxLen = rxFF = rxExpect = 0;
+        rxOverflow = false;
+    }
+
+    static void rxDispatch() {
+        if (rxLen == 0) return;
+        rxStats.frames++;
+
+        RxEvent e = {};
+        e.page = currentPage;
+
+        switch (rxFrame[0]) {
+            case 0x65:
+                e.type      = RxType::TOUCH;
+                e.page      = rxFrame[1];
+                e.component = rxFrame[2];
+                e.pressed   = rxFrame[3] == 0x01;
+                break;
+            case 0x66:
+                e.type = RxType::PAGE;
+                e.page = rxFrame[1];
+                break;
+            case 0x71:
+                e.type   = RxType::NUMBER;
+                e.number = (int32_t)((uint32_t)rxFrame[1] | (uint32_t)rxFrame[2] << 8 |
+                                     (uint32_t)rxFrame[3] << 16 | (uint32_t)rxFrame[4] << 24);
+                break;
+            case 0x70: {
+                static char text[DISPLAY_RX_TEXT + 1];
+                uint8_t n = rxLen - 1;
+                memcpy(text, rxFrame + 1, n);
+                text[n] = 0;
+                e.type = RxType::STRING;
+                e.text = text;
+                break;
+            }
+            default:
+                // Single byte return codes: 0x01 ok, 0x88 ready, sleep/wake
+                if (rxLen != 1 || (rxFrame[0] != 0x01 && rxFrame[0] < 0x80))
+                    rxStats.errors++;
+                return;
+        }
+        if (rxOverflow) rxStats.errors++;
+
+        // Touch and page frames tell us what the panel is showing
+        if ((e.type == RxType::TOUCH || e.type == RxType::PAGE) && e.page != currentPage) {
+            currentPage = e.page;
+            invalidateWidgets();
+        }
+        if (rxHandler && rxFrame[0] != 0x67 && rxFrame[0] != 0x68) rxHandler(e);
+    }
+
+    static void rxByte(uint8_t b) {
+        if (rxLen == 0 && rxFF == 0) rxExpect = rxFrameLength(b);
+
+        if (rxExpect && rxLen < rxExpect) {
+            rxStore(b);
+            return;
+        }
+        if (b == 0xFF) {
+            if (++rxFF == 3) {
+                rxDispatch();
+                rxReset();
+            }
+            return;
+        }
+        if (rxExpect) {
+            // Fixed frame not terminated: drop it and resync on this byte
+            rxStats.errors++;
+            rxReset();
+            rxByte(b);
+            return;
+        }
+        while (rxFF) { rxStore(0xFF); rxFF--; }     // FFs were text
+        rxStore(b);
+    }
+
+    void setRxHandler(RxHandler handler) { rxHandler = handler; }
+    RxStats getRxStats() { return rxStats; }
+
+    void pump() {
+        if (!port) return;
+
+        for (uint8_t n = 0; n < DISPLAY_RX_BUDGET && port->available() > 0; n++)
+            rxByte(port->read());
+
+        flushWidgets();
+        noInterrupts();
+        flushSlots();
+        interrupts();
+
+        int room = port->availableForWrite();
+        while (room > 0 && txTail != txHead) {
+            uint16_t tail  = txTail;
+            uint16_t head  = txHead;
+            uint16_t chunk = (head > tail) ? head - tail : DISPLAY_TX_RING - tail;
+            if (chunk > (uint16_t)room) chunk = room;
+
+            port->write(&txRing[tail], chunk);
+            txTail = (tail + chunk) & TX_MASK;
+            room -= chunk;
+            bytesThisSecond += chunk;
+        }
+
+        if (statsTimer >= 1000) {
+            txStats.bytesPerSec = bytesThisSecond;
+            bytesThisSecond = 0;
+            statsTimer = 0;
+        }
+    }
+
+    void flush() {
+        if (!port) return;
+        pump();
+        while (txTail != txHead) {
+            yield();
+            pump();
+        }
+        port->flush();
+    }
+
+    uint16_t txQueued() { return txUsed(); }
+
+    bool frameBudgetLeft(const elapsedMicros &frameTime) {
+        return frameTime < DISPLAY_FRAME_US && txUsed() < DISPLAY_FRAME_BYTES;
+    }
+
+    TxStats getTxStats() {
+        TxStats s = txStats;
+        s.queued = txUsed();
+        return s;
+    }
+
+    // ------------------ COMMAND BUILDER ------------------
+    uint8_t formatInt(char* out, int32_t value) {
+        char digits[10];
+        uint8_t n = 0, len = 0;
+        uint32_t v = value < 0 ? -(uint32_t)value : (uint32_t)value;
+
+        do {
+            digits[n++] = '0' + v % 10;
+            v /= 10;
+        } while (v);
+
+        if (value < 0) out[len++] = '-';
+        while (n) out[len++] = digits[--n];
+        return len;
+    }
+
+    Cmd::Cmd(const char* op) {
+        while (*op && len < DISPLAY_CMD_LEN - 1) buf[len++] = *op++;
+    }
+
+    void Cmd::separate() {
+        if (len < DISPLAY_CMD_LEN - 1) buf[len++] = args++ ? ',' : ' ';
+    }
+
+    Cmd& Cmd::num(int32_t value) {
+        separate();
+        if (len + 11 < DISPLAY_CMD_LEN) len += formatInt(buf + len, value);
+        return *this;
+    }
+
+    Cmd& Cmd::str(const char* text) {
+        separate();
+        if (len < DISPLAY_CMD_LEN - 1) buf[len++] = '"';
+        while (*text && len < DISPLAY_CMD_LEN - 2) buf[len++] = *text++;
+        buf[len++] = '"';
+        return *this;
+    }
+
+    void Cmd::send() {
+        writeCmd(buf, len);
+    }
+
+    // ------------------ API ------------------
     void init(HardwareSerial &serialPort, uint32_t baud, uint8_t brightness) {
         if(displayInstance) delete displayInstance;
         displayInstance = new EasyNex(serialPort);
         displayInstance->begin(baud);
+        port = &serialPort;
+        port->addMemoryForWrite(serialTxBuffer, sizeof(serialTxBuffer));
+        port->addMemoryForRead(serialRxBuffer, sizeof(serialRxBuffer));
         delay(500);
         setBrightness(brightness);
     }
   
     void setBrightness(uint8_t bright) {
-        if(displayInstance) {
-            char cmd[16];
-            snprintf(cmd, sizeof(cmd), "dim=%d", bright);
-            displayInstance->writeStr(cmd, ""); // empty value, just send command
-        }
+        char cmd[16] = "dim=";
+        uint8_t len = 4 + formatInt(cmd + 4, bright);
+        writeCmd(cmd, len);
     }
 
     void writeStr(const char* obj, const char* value) {
-        if(displayInstance) displayInstance->writeStr(obj, value);
+        writeWidget(obj, value, true);
     }
 
+    // Raw commands keep their order relative to queued object writes
     void writeCmd(const char* value) {
-        if(displayInstance) displayInstance->writeStr(value);
+        writeCmd(value, strlen(value));
+    }
+
+    void writeCmd(const char* cmd, uint16_t len) {
+        noInterrupts();
+        flushSlots();
+        enqueue(cmd, len);
+        interrupts();
     }
 
     void writeNum(const char* obj, int32_t value) {
-        if(displayInstance) displayInstance->writeNum(obj, value);
+        char num[12];
+        num[formatInt(num, value)] = 0;
+        writeWidget(obj, num, false);
     }
 
+    // Objects reload their designed values when a page opens
+    void setPage(uint8_t page) {
+        Cmd("page").num(page).send();
+        currentPage = page;
+        invalidateWidgets();
+    }
+
+    uint8_t getPage() { return currentPage; }
+
     EasyNex* getInstance() {
         return displayInstance;
 
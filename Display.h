@@ -6,15 +6,115 @@
 
 namespace Display {
 
+    // --- Transport ---
+    #define DISPLAY_TX_RING    8192     // queued command bytes, power of two
+    #define DISPLAY_TX_SERIAL  1024     // extra interrupt-driven UART buffer
+    #define DISPLAY_SLOTS      32       // coalesced object writes per frame
+    #define DISPLAY_OBJ_LEN    24
+    #define DISPLAY_VAL_LEN    40
+    #define DISPLAY_CMD_LEN    96       // longest single command
+    #define DISPLAY_WIDGETS    64       // objects with a cached value
+    #define DISPLAY_RX_SERIAL  256      // extra interrupt-driven UART RX buffer
+    #define DISPLAY_RX_BUDGET  64       // bytes parsed per pump()
+    #define DISPLAY_RX_TEXT    48       // longest string reply kept
+
+    struct TxStats {
+        uint32_t bytesPerSec;       // sent during the last second
+        uint16_t queued;            // bytes waiting in the ring
+        uint16_t queuedMax;
+        uint32_t coalesced;         // writes replaced before they were sent
+        uint32_t dropped;           // commands lost to a full ring
+        uint32_t unchanged;         // writes skipped, value already shown
+    };
+
+    // --- Receive ---
+    // Return frames from the panel, parsed incrementally by pump()
+    enum class RxType : uint8_t {
+        TOUCH,          // 0x65 page, component, press/release
+        PAGE,           // 0x66 current page
+        NUMBER,         // 0x71 get reply
+        STRING          // 0x70 get reply
+    };
+
+    struct RxEvent {
+        RxType      type;
+        uint8_t     page;
+        uint8_t     component;
+        bool        pressed;
+        int32_t     number;
+        const char* text;           // valid during the callback only
+    };
+
+    struct RxStats {
+        uint32_t frames;
+        uint32_t errors;            // error return codes and broken frames
+    };
+
+    typedef void (*RxHandler)(const RxEvent &e);
+    void setRxHandler(RxHandler handler);
+    RxStats getRxStats();
+
     // --- Exposed functions ---
     void init(HardwareSerial &serialPort, uint32_t baud = 921600, uint8_t brightness = 10);
     void writeStr(const char* obj, const char* value);
     void writeCmd(const char* value);
+    void writeCmd(const char* cmd, uint16_t len);
     void writeNum(const char* obj, int32_t value);
     void setBrightness(uint8_t bright);
+
+    // --- Widgets ---
+    // writeNum/writeStr remember the last value sent per object and skip
+    // repeats. An object may also be rate limited; changes inside the
+    // interval are held and the latest one is sent when it expires.
+    void setWidgetInterval(const char* obj, uint16_t minIntervalMs);
+    void invalidateWidgets();       // resend everything, e.g. after a page change
+
+    void pump();                    // non-blocking TX and RX, call from loop()
+    void flush();                   // blocks until the queue is sent
+    TxStats getTxStats();
+    uint16_t txQueued();            // bytes waiting to be sent
+
+    // --- Frames ---
+    // Views redraw at most once per frame and work until the frame's CPU
+    // time or the TX queue runs out; unfinished work continues next frame.
+    #define DISPLAY_FRAME_MS     33     // ~30 fps
+    #define DISPLAY_FRAME_US     1500   // CPU time per frame
+    #define DISPLAY_FRAME_BYTES  2048   // queue depth at which a frame yields
+    bool frameBudgetLeft(const elapsedMicros &frameTime);
+
+    // --- Command builder ---
+    // Formats a command on the stack without printf and queues it:
+    //   Display::Cmd("fill").num(x).num(y).num(w).num(h).num(color).send();
+    uint8_t formatInt(char* out, int32_t value);   // returns length, no terminator
+
+    class Cmd {
+    public:
+        explicit Cmd(const char* op);
+        Cmd& num(int32_t value);
+        Cmd& str(const char* text);     // quoted argument
+        void send();
+
+    private:
+        void separate();
+
+        char    buf[DISPLAY_CMD_LEN];
+        uint8_t len  = 0;
+        uint8_t args = 0;
+    };
+
+    // --- Pages ---
+    enum Page : uint8_t {
+        PAGE_LOAD = 0,
+        PAGE_MAIN = 1,
+        PAGE_DIAG = 2,
+        PAGE_SAMPLE = 3,
+        PAGE_OVERVIEW = 4
+    };
+    void setPage(uint8_t page);
+    uint8_t getPage();
+
     EasyNex* getInstance(); // optional, if you need direct access
 
 } // namespace Display
 
 #endif
-
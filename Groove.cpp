@@ -0,0 +1,153 @@
+#include "Groove.h"
+
+namespace Groove {
+
+    enum class Kind : uint8_t { FREE, SWING, USER };
+
+    struct TableInfo {
+        Kind    kind;
+        uint8_t swing;              // SWING tables
+        uint8_t users;              // tracks pointing here
+    };
+
+    static DMAMEM uint16_t tables[GROOVE_TABLES][GROOVE_PERIOD];
+    static TableInfo info[GROOVE_TABLES];
+    static volatile uint8_t trackTable[MAX_TRACKS];
+    static uint8_t swingOf[MAX_TRACKS];
+    static int8_t  lastUser = -1;
+
+    void init() {
+        memset(info, 0, sizeof(info));
+        memset((void*)trackTable, GROOVE_NONE, sizeof(trackTable));
+        memset(swingOf, SWING_STRAIGHT, sizeof(swingOf));
+        lastUser = -1;
+    }
+
+    const uint16_t* warpTable(uint8_t trackId) {
+        uint8_t t = trackTable[trackId];
+        return (t == GROOVE_NONE) ? nullptr : tables[t];
+    }
+
+    int8_t lastExtracted() { return lastUser; }
+
+    // ------------------ POOL ------------------
+    static int8_t allocTable() {
+        for (uint8_t i = 0; i < GROOVE_TABLES; i++)
+            if (info[i].kind == Kind::FREE) return i;
+        // an extracted groove nobody uses, other than the latest
+        for (uint8_t i = 0; i < GROOVE_TABLES; i++)
+            if (info[i].kind == Kind::USER && info[i].users == 0 && i != lastUser) return i;
+        return -1;
+    }
+
+    static void release(uint8_t t) {
+        if (t == GROOVE_NONE) return;
+        if (info[t].users) info[t].users--;
+        if (info[t].users == 0 && info[t].kind == Kind::SWING) info[t].kind = Kind::FREE;
+    }
+
+    // One byte store, so the clock sees either table; it never runs
+    // concurrently with the main loop, so the old one can be freed after
+    void assign(uint8_t trackId, int8_t table) {
+        if (trackId >= MAX_TRACKS) return;
+        uint8_t t = (table < 0 || table >= GROOVE_TABLES || info[table].kind == Kind::FREE)
+                    ? GROOVE_NONE : (uint8_t)table;
+        uint8_t old = trackTable[trackId];
+        if (t == old) return;
+        if (t != GROOVE_NONE) info[t].users++;
+        trackTable[trackId] = t;
+        release(old);
+    }
+
+    // ------------------ BUILD ------------------
+    // Each 8th pair: the first 16th is stretched to `percent` of the pair
+    // and the second squeezed into the rest
+    static void buildSwing(uint16_t* w, uint8_t percent) {
+        const uint32_t pair = 2 * TICKS_PER_STEP;
+        const uint32_t mid  = (pair * percent + 50) / 100;
+        for (uint32_t t = 0; t < GROOVE_PERIOD; t++) {
+            uint32_t pos = t % pair;
+            uint32_t out = (pos < TICKS_PER_STEP)
+                         ? pos * mid / TICKS_PER_STEP
+                         : mid + (pos - TICKS_PER_STEP) * (pair - mid) / TICKS_PER_STEP;
+            w[t] = t - pos + out;
+        }
+    }
+
+    void setSwing(uint8_t trackId, uint8_t percent) {
+        if (trackId >= MAX_TRACKS) return;
+        percent = constrain(percent, SWING_STRAIGHT, SWING_MAX);
+        if (percent == swingOf[trackId]) return;    // keeps an assigned groove
+
+        int8_t t = -1;
+        if (percent != SWING_STRAIGHT) {
+            for (uint8_t i = 0; i < GROOVE_TABLES && t < 0; i++)
+                if (info[i].kind == Kind::SWING && info[i].swing == percent) t = i;
+
+            if (t < 0) {
+                // The track's own swing table, when nobody shares it, is
+                // rebuilt aside and swapped in whole, so the clock never
+                // reads a half-built table
+                uint8_t own = trackTable[trackId];
+                if (own != GROOVE_NONE && info[own].kind == Kind::SWING && info[own].users == 1) {
+                    uint16_t w[GROOVE_PERIOD];
+                    buildSwing(w, percent);
+                    noInterrupts();
+                    memcpy(tables[own], w, sizeof(w));
+                    interrupts();
+                    info[own].swing = percent;
+                    swingOf[trackId] = percent;
+                    return;
+                }
+                t = allocTable();
+                if (t < 0) return;          // pool full, retried on the next change
+                buildSwing(tables[t], percent);
+                info[t] = { Kind::SWING, percent, 0 };
+            }
+        }
+        assign(trackId, t);
+        swingOf[trackId] = percent;
+    }
+
+    // Mean offset of the note-ons from each 16th of the bar, as anchors
+    // joined linearly; steps without notes stay on the grid
+    int8_t extract(uint8_t srcTrack) {
+        if (srcTrack >= MAX_TRACKS) return -1;
+        const Sequencer::Pattern &p = Sequencer::curSeq().tracks[srcTrack].pattern;
+
+        int32_t  sum[STEPS_PER_BAR] = {};
+        uint16_t cnt[STEPS_PER_BAR] = {};
+        uint16_t notes = 0;
+        for (uint16_t i = 0; i < p.count; i++) {
+            const Sequencer::Event &e = p.events[i];
+            if (e.type != Sequencer::EventType::NOTE_ON) continue;
+            uint32_t step = (e.tick + TICKS_PER_STEP / 2) / TICKS_PER_STEP;
+            sum[step % STEPS_PER_BAR] += (int32_t)e.tick - (int32_t)(step * TICKS_PER_STEP);
+            cnt[step % STEPS_PER_BAR]++;
+            notes++;
+        }
+        if (notes == 0) return -1;
+
+        int8_t t = allocTable();
+        if (t < 0) return -1;
+
+        int32_t anchor[STEPS_PER_BAR + 1];
+        for (uint8_t k = 0; k < STEPS_PER_BAR; k++) {
+            int32_t off = cnt[k] ? (int32_t)floorf((float)sum[k] / cnt[k] + 0.5f) : 0;
+            off = constrain(off, (k == 0) ? 0 : -GROOVE_MAX_OFFSET, GROOVE_MAX_OFFSET);
+            anchor[k] = k * TICKS_PER_STEP + off;
+        }
+        anchor[STEPS_PER_BAR] = GROOVE_PERIOD;
+
+        uint16_t* w = tables[t];
+        for (uint8_t k = 0; k < STEPS_PER_BAR; k++) {
+            int32_t span = anchor[k + 1] - anchor[k];
+            for (uint32_t i = 0; i < TICKS_PER_STEP; i++)
+                w[k * TICKS_PER_STEP + i] = anchor[k] + i * span / TICKS_PER_STEP;
+        }
+        info[t] = { Kind::USER, 0, 0 };
+        lastUser = t;
+        return t;
+    }
+
+} // namespace Groove
@@ -0,0 +1,37 @@
+#ifndef GROOVE_H
+#define GROOVE_H
+
+#include <Arduino.h>
+#include "Sequencer.h"
+
+namespace Groove {
+
+    // ------------------ CONFIG ------------------
+    #define GROOVE_PERIOD      TICKS_PER_BAR
+    #define GROOVE_TABLES      8
+    #define GROOVE_NONE        0xFF
+    #define SWING_STRAIGHT     50           // percent, MPC style
+    #define SWING_MAX          75
+    #define GROOVE_MAX_OFFSET  (TICKS_PER_STEP / 2 - 1)   // keeps steps in order
+
+    // A groove is a table mapping each stored tick of a bar to the tick it
+    // plays on. Tables are monotonic, so playback order and the sequencer's
+    // play cursor hold; patterns are never rewritten. Tracks point into a
+    // shared pool, so a new swing amount is one table build and an index swap.
+    void init();
+    void setSwing(uint8_t trackId, uint8_t percent);    // 16th swing, SWING_STRAIGHT = off
+    int8_t extract(uint8_t srcTrack);                  // groove of the recorded note-ons, or -1
+    void assign(uint8_t trackId, int8_t table);        // GROOVE_NONE = straight
+    int8_t lastExtracted();
+
+    const uint16_t* warpTable(uint8_t trackId);        // nullptr = straight
+
+    inline uint32_t warp(const uint16_t* table, uint32_t tick) {
+        if (!table) return tick;
+        uint32_t pos = tick % GROOVE_PERIOD;
+        return tick - pos + table[pos];
+    }
+
+} // namespace Groove
+
+#endif
@@ -4,6 +4,13 @@
 #include "Sequencer.h"
 #include "AudioEngine.h"
 #include "Display.h"
+#include "AudioGovernor.h"
+#include "WaveView.h"
+#include "Overview.h"
+#include "Params.h"
+#include "Automation.h"
+#include "PatternEdit.h"
+#include "Groove.h"
 
 
 namespace Input {
@@ -12,6 +19,7 @@ namespace Input {
     elapsedMillis trellisTimer;
     elapsedMillis encTimer;
     const uint8_t TRELLIS_INTERVAL = 8;
+    const uint16_t TRELLIS_FIFO_WAIT_US = 500;    // seesaw needs this between count and FIFO reads
     const uint8_t ENC_INTERVAL = 20;
 
     // ----------------------------------------------------------------------------------//
@@ -69,17 +77,13 @@ namespace Input {
         if (Input::shiftActive) {
             // Toggle ARP mode
             if (Sequencer::arpMode == Sequencer::ArpMode::OFF) {
-                Sequencer::arpMode = Sequencer::ArpMode::UP_OCTAVE; // or last used
-                Sequencer::setArpMode(Sequencer::ArpMode::UP_OCTAVE);
+                Sequencer::setArpMode(Sequencer::ArpMode::UP); // or last used
             }
             else {
-                Sequencer::arpMode = Sequencer::ArpMode::OFF;
                 Sequencer::setArpMode(Sequencer::ArpMode::OFF);
             }
             // Reset ARP state
-            Sequencer::arpVoice.active = false;
-            Sequencer::arpVoice.noteOn = false;
-            Sequencer::numHeldNotes = 0;
+            Sequencer::resetArp();
             return;
         }
     }
@@ -89,14 +93,7 @@ namespace Input {
 
         // ---------- ARP handling ----------
         if (Sequencer::arpMode != Sequencer::ArpMode::OFF) {
-            if (Sequencer::arpVoice.noteOn) {
-                AudioEngine::noteOff(Sequencer::arpVoice.trackId, Sequencer::arpVoice.note);
-                if (Sequencer::isRecording)
-                    Sequencer::recordNoteEvent(Sequencer::arpVoice.trackId, Sequencer::arpVoice.note, 0);
-            }
-            Sequencer::arpVoice.active = false;
-            Sequencer::arpVoice.noteOn = false;
-            Sequencer::numHeldNotes = 0;
+            if (!Sequencer::arpLatch) Sequencer::resetArp();
             return;
         }
 
@@ -125,9 +122,11 @@ namespace Input {
     void onF3() { 
         f3Active = !f3Active; 
         if (Input::shiftActive) {
+            PatternEdit::begin();       // one undo step for all tracks
             for (uint16_t i = 0; i < MAX_TRACKS; i++) {
                 Sequencer::clearPattern(i);
             }
+            PatternEdit::end();
         }
         else {
             Sequencer::clearPattern(Sequencer::getCurrentTrack());
@@ -140,11 +139,35 @@ namespace Input {
         else {clearAllTrackLEDs();}
     }
 
-    void onF5() { f5Active = !f5Active; }
-    void onF6() { f6Active = !f6Active; }
+    // F5: undo, SHIFT + F5: redo
+    void onF5() {
+        f5Active = !f5Active;
+        if (shiftActive) PatternEdit::redo();
+        else PatternEdit::undo();
+    }
+    void onF6() {
+        // SHIFT + F6: toggle serial audio report
+        if (shiftActive) {
+            static bool report = false;
+            report = !report;
+            AudioGovernor::setSerialReport(report);
+            return;
+        }
+        // F6: diagnostics page
+        f6Active = !f6Active;
+        if (f6Active) {
+            Display::setPage(Display::PAGE_DIAG);
+        } else {
+            Display::setPage(Display::PAGE_MAIN);
+            Sequencer::redrawPage();
+        }
+    }
+
+    void onButtonEdge(uint8_t id, bool pressed);
 
     void initButtons() {
         mux.begin();
+        manager.setEdgeHandler(onButtonEdge);
         manager.begin();
 
         PLAY_FROM_START = manager.addMuxButton(&mux, 0, onPlayFromStart, nullptr, true);
@@ -158,7 +181,7 @@ namespace Input {
         F3              = manager.addMuxButton(&mux, 7, onF3, nullptr, false);
         F4              = manager.addMuxButton(&mux, 6, onF4, nullptr, false);
         F5              = manager.addMuxButton(&mux, 5, onF5, nullptr, false);
-        F6              = manager.addMuxButton(&mux, 4, onF6, nullptr, false);
+        F6              = manager.addMuxButton(&mux, 4, onF6, nullptr, true);
 
     }
 
@@ -256,7 +279,14 @@ namespace Input {
         ENC_PRESS,
         ENC_RELEASE,
         PAD_PRESS,
-        PAD_RELEASE
+        PAD_RELEASE,
+        BUTTON_PRESS,       // id = ButtonManager index
+        BUTTON_RELEASE,
+        TOUCH_PRESS,        // id = component, delta = page
+        TOUCH_RELEASE,
+        PAGE_CHANGE,        // id = page
+        DISPLAY_NUMBER,     // delta = value
+        DISPLAY_STRING      // text in lastDisplayText
     };
 
     struct InputEvent {
@@ -264,6 +294,7 @@ namespace Input {
         uint8_t id;       // encoder index or pad key
         int32_t delta;    // only used for encoder turns
         uint32_t dt;         // time since last tick (ms)
+        uint32_t cycles;     // ARM_DWT_CYCCNT at capture
     };
 
     // Ring buffer
@@ -282,11 +313,27 @@ namespace Input {
         return true;
     }
 
+    // Also called from the button scan ISR, so loop-side writers lock out
+    // that producer while they claim a slot
     void pushInputEvent(const InputEvent &e) {
+        noInterrupts();
         uint8_t next = (evtW + 1) % INPUT_EVENT_BUF;
-        if (next == evtR) return; // overflow, drop event
+        if (next == evtR) {   // overflow, drop event
+            interrupts();
+            return;
+        }
         inputEvents[evtW] = e;
+        inputEvents[evtW].cycles = ARM_DWT_CYCCNT;
         evtW = next;
+        interrupts();
+    }
+
+    // Button edges leave the ISR as events; callbacks run in processInputEvents
+    void onButtonEdge(uint8_t id, bool pressed) {
+        InputEvent e = {};
+        e.type = pressed ? InputEventType::BUTTON_PRESS : InputEventType::BUTTON_RELEASE;
+        e.id   = id;
+        pushInputEvent(e);
     }
 
     // ----------------------------------------------------------------------------------//
@@ -312,125 +359,44 @@ namespace Input {
         int32_t delta;     // + / - steps (TURN only)
     };
 
-    float computeAccel(uint32_t dt, float maxAccel) {
-        if (dt == 0) dt = 1;  // avoid divide by zero
-
-        // normalized speed: smaller dt = faster turn
-        float speed = 100.0f / float(dt);   // tweak 50.0f for sensitivity
-        speed = constrain(speed, 0.0f, maxAccel);
-
-        // exponential curve: 1.0 → maxAccel
-        float accel = 1.0f + pow(speed, 2.0f);
-        accel = constrain(accel, 1.0f, maxAccel);
-        return accel;
-    }
-
-    struct EncoderMapping {
-        EncParam param;
-        float minVal;
-        float maxVal;
-        float step;
-        float *currentValue;
-        float displayScale;   // e.g. 100 for %, 1 for raw
-        uint8_t decimals;     // number of decimals to show
-        float maxAccel;
-    };
-
     EncoderEvent encEvents[ENC_EVENT_BUF];
     volatile uint8_t encEvtW = 0, encEvtR = 0;
 
-    #define NUM_ENCODER_PAGES 4
-    EncoderMapping* currentMap = nullptr;
-    //EncoderMapping* currentMap = encMapSynth;
-
-    static const char* encoderPageNames[] = {
-        "SYNTH",
-        "ADSR",
-        "ARP",
-        "GLOBAL"
-    };
-    // ---------- SYNTH encoder values ----------
-    float cutoff = 2000;
-    float resonance = 0.7;
-    float crushBits = 8;
-    float osc1pulse = 0.5;
-
-    EncoderMapping encMapSynth[NUM_ENCODERS] = {
-        { EncParam::FILTER_CUTOFF,    0, 8000, 50, &cutoff, 100.0f / 8000.0f, 0, 50.0f },
-        { EncParam::FILTER_RESONANCE, 0, 4,  0.05, &resonance, 100.0f / 4, 0, 50.0f},
-        { EncParam::BITCRUSH_BITS,    4,   16,   1, &crushBits, 1.0f, 0, 50.0f},
-        { EncParam::OSC1_PULSE,       0,   3,   1, &osc1pulse, 100.0f / 4, 0, 50.0f}
-    };
-
-    // ---------- ADSR encoder values ----------
-    float attack = 0;
-    float decay = 10;
-    float sustain = 10;
-    float release = 20;
-
-    EncoderMapping encMapADSR[NUM_ENCODERS] = {
-        { EncParam::ENV_ATT, 0, 1000, 10, &attack, 100.0f / 1000, 0, 10.0f},
-        { EncParam::ENV_DEC, 0, 1000, 10, &decay, 100.0f / 1000, 0, 10.0f},
-        { EncParam::ENV_SUS, 0, 1000, 10, &sustain, 100.0f / 1000, 0, 10.0f},
-        { EncParam::ENV_REL, 0, 2000, 10, &release, 100.0f / 2000, 0, 10.0f}
-    };
-
-    // ---------- ARP encoder values ----------
-    float arpRateVal    = 2;   // index into enum
-    float arpOctaveVal  = 2;
-    float arpModeVal    = 1;
-    float arpGateVal    = 0.8f;
-
-    EncoderMapping encMapArp[NUM_ENCODERS] = {
-        { EncParam::ARP_RATE,    0, 5, 1,   &arpRateVal, 1.0f, 0, 10.0f  }, // enum index
-        { EncParam::ARP_OCTAVES, 1, 4, 1,   &arpOctaveVal, 1.0f, 0, 10.0f },
-        { EncParam::ARP_MODE,    0, 3, 1,   &arpModeVal, 1.0f, 0, 10.0f  },
-        { EncParam::ARP_GATE,    0.1, 1.0, 0.05, &arpGateVal, 100.0f, 0, 10.0f }
-    };
-
-    // ---------- GLOBAL encoder values ----------
-    float volume = 0.5;
-    float main2 = 0;
-    float main3 = 0;
-    float main4 = 0;
-
-    EncoderMapping encMapMain[NUM_ENCODERS] = {
-         //         param   min  max  step  value  scale  decimals accel
-        { EncParam::MAIN_VOL, 0.0, 1.0, 0.05, &volume, 100.0f, 0, 10.0f },
-        { EncParam::MAIN_2,   0,   100, 1,   &main2,   1.0f, 0, 10.0f },
-        { EncParam::MAIN_3,   0,   100, 1,   &main3,   1.0f, 0, 10.0f },
-        { EncParam::MAIN_4,   0,   100, 1,   &main4,   1.0f, 0, 10.0f }
-    };
+    static uint8_t currentEncoderPage = 0;
 
     uint32_t lastEncTick[NUM_ENCODERS] = {0};
 
-    void readEncoders() {
-        if (encTimer <= ENC_INTERVAL) return;
-
+    static void pushEncoderTurn(uint8_t i, int32_t pos) {
         uint32_t now = millis();
+        int32_t delta = pos - encPos[i];
+        if (delta == 0) return;
 
-        for (int i = 0; i < NUM_ENCODERS; i++) {
+        uint32_t dt = now - lastEncTick[i];  // time since last move
+        if (dt > 200) dt = 200;              // clamp for slow rotations
+        lastEncTick[i] = now;
 
-            // --- ROTATION ---
-            int32_t pos = encBoards[i]->getEncoderPosition(i);
-            int32_t delta = pos - encPos[i];
-            if (delta != 0) {
-                uint32_t dt = now - lastEncTick[i];  // time since last move
-                if (dt > 200) dt = 200;              // clamp for slow rotations
-                lastEncTick[i] = now;
+        encPos[i] = pos;
 
-                encPos[i] = pos;
+        InputEvent e;
+        e.type  = InputEventType::ENC_TURN;
+        e.id    = i;
+        e.delta = delta;
+        e.dt    = dt;           // send real delta time
+        pushInputEvent(e);
+    }
 
-                InputEvent e;
-                e.type  = InputEventType::ENC_TURN;
-                e.id    = i;
-                e.delta = delta;
-                e.dt    = dt;           // send real delta time
-                pushInputEvent(e);
+    // All buttons of a board in one GPIO bulk read
+    static void readEncoderButtons() {
+        uint32_t bits = 0;
+        for (int i = 0; i < NUM_ENCODERS; i++) {
+            if (i == 0 || encBoards[i] != encBoards[i - 1]) {
+                uint32_t mask = 0;
+                for (int j = i; j < NUM_ENCODERS && encBoards[j] == encBoards[i]; j++)
+                    mask |= (1UL << encPins[j]);
+                bits = encBoards[i]->digitalReadBulk(mask);
             }
 
-            // --- BUTTON ---
-            bool btn = encBoards[i]->digitalRead(encPins[i]);
+            bool btn = (bits >> encPins[i]) & 1;
             if (btn != encButtonPrev[i]) {
                 InputEvent e;
                 e.type  = (btn == LOW) ? InputEventType::ENC_PRESS : InputEventType::ENC_RELEASE;
@@ -442,72 +408,41 @@ namespace Input {
                 encButtonPrev[i] = btn;
             }
         }
+    }
 
-        encTimer = 0;
+    static void readEncoderPosition(uint8_t i) {
+        pushEncoderTurn(i, encBoards[i]->getEncoderPosition(i));
     }
 
     void handleEncoderEvent(const InputEvent &e) {
-        if (currentMap == nullptr) return;
-
-        auto &m = currentMap[e.id];   // current mapping
-
-        float baseStep = m.step;
-        float effectiveStep = baseStep;
+        if (e.type != InputEventType::ENC_TURN) return;
 
-        // --- ACCELERATION ---
-        float speed = (e.dt > 0) ? 1.0f / float(e.dt) : 0.0f;   // faster turn → smaller dt → larger speed
-        float accel = computeAccel(e.dt, m.maxAccel);                    // tune factor
+        EncParam id = Params::pages[currentEncoderPage].slots[e.id];
+        uint8_t track = Sequencer::getCurrentTrack();
+        float value = Params::nudge(track, id, e.delta, e.dt);
 
-        // --- Fine scaling for small ranges ---
-        if ((m.maxVal - m.minVal) < 10.0f) {
-            accel = 1.0f + speed;   // less aggressive
-        }
-
-        effectiveStep = baseStep * accel;
-
-        // --- APPLY ---
-        *m.currentValue += e.delta * effectiveStep;
-        *m.currentValue = constrain(*m.currentValue, m.minVal, m.maxVal);
-
-        int displayValue = roundf(*m.currentValue * m.displayScale);
+        // While recording, turns also lock the value onto the step under the playhead
+        if (Sequencer::isRecording && Sequencer::isPlaying)
+            Automation::setLock(track, Sequencer::playheadTick / TICKS_PER_STEP, id, value);
 
-        // --- UPDATE ENGINE ---
-        if (currentMap == encMapSynth || currentMap == encMapADSR) {
-            AudioEngine::setSynthParam(m.param, *m.currentValue);
-        }
-        else if (currentMap == encMapArp) {
-            switch(e.id) {
-                case 0: Sequencer::arpRate  = (Sequencer::TimingDivision)(int)*m.currentValue; break;
-                case 1: Sequencer::arpOctaves = (uint8_t)*m.currentValue; break;
-                case 2: Sequencer::arpMode    = (Sequencer::ArpMode)(int)*m.currentValue; break;
-                case 3: Sequencer::arpGate    = *m.currentValue; break;
-            }
-            Sequencer::recalcArpTiming();
-        }
-        else if (currentMap == encMapMain) {
-            AudioEngine::setMainParam(m.param, *m.currentValue);
-        }
-
-        Display::writeNum(encNames[e.id], displayValue);
+        Display::writeNum(encNames[e.id], Params::displayValue(id, value));
     }
 
-    static uint8_t currentEncoderPage = 0;
-
-    void setEncoderPageInternal(uint8_t page) {
-        switch (page) {
-            case 0: currentMap = encMapSynth; break;
-            case 1: currentMap = encMapADSR;  break;
-            case 2: currentMap = encMapArp;   break;
-            case 3: currentMap = encMapMain;  break;
+    // Shows the current track's values for the active page
+    void refreshEncoderLabels() {
+        uint8_t track = Sequencer::getCurrentTrack();
+        for (uint8_t i = 0; i < NUM_ENCODERS; i++) {
+            EncParam id = Params::pages[currentEncoderPage].slots[i];
+            Display::writeNum(encNames[i], Params::displayValue(id, Params::get(track, id)));
         }
     }
 
     void setEncoderPage(uint8_t page) {
-        currentEncoderPage = constrain(page, 0, NUM_ENCODER_PAGES - 1);
-        setEncoderPageInternal(currentEncoderPage);
+        currentEncoderPage = constrain(page, 0, NUM_PARAM_PAGES - 1);
 
         // Optional UI feedback
-        Display::writeStr("encPage.txt", encoderPageNames[currentEncoderPage]);
+        Display::writeStr("encPage.txt", Params::pages[currentEncoderPage].name);
+        refreshEncoderLabels();
     }
 
     // ----------------------------------------------------------------------------------//
@@ -550,11 +485,48 @@ namespace Input {
 
     volatile bool trellisDirty = false;
 
-    void readPads() {
-        if(trellisTimer > TRELLIS_INTERVAL){
-        trellis.read();   // <--- no parameters!
-        trellisTimer = 0;
-        } 
+    // MultiTrellis::read() scans every board back to back and waits 500 us
+    // after each count. Here a scan moves one step per call: read a board's
+    // event count, then on a later pass, once the wait has passed elsewhere,
+    // drain its FIFO. Keys are numbered across boards as MultiTrellis does.
+    static uint8_t padBoard = 0;            // board being scanned
+    static uint8_t padCount = 0;            // events waiting on it, 0 = read the count next
+    static elapsedMicros padWait;
+
+    TrellisCallback keyPress(keyEvent evt);
+
+    static void readPads() {
+        constexpr uint8_t cols   = X_DIM / 4;
+        constexpr uint8_t boards = (Y_DIM / 4) * cols;
+        Adafruit_NeoTrellis &t = t_array[padBoard / cols][padBoard % cols];
+
+        if (padCount == 0) {
+            padCount = t.getKeypadCount();
+            padWait = 0;
+            if (padCount) return;
+        } else {
+            keyEventRaw raw[NEO_TRELLIS_NUM_KEYS * 2];
+            uint8_t count = min((uint8_t)(padCount + 2), (uint8_t)(sizeof(raw) / sizeof(raw[0])));  // +2 as MultiTrellis
+            padCount = 0;
+            if (t.readKeypad(raw, count)) {
+                for (uint8_t i = 0; i < count; i++) {
+                    uint8_t key = NEO_TRELLIS_SEESAW_KEY(raw[i].bit.NUM);
+                    if (key >= NEO_TRELLIS_NUM_KEYS) continue;     // empty FIFO slot
+                    uint8_t x = NEO_TRELLIS_X(key) + (padBoard % cols) * NEO_TRELLIS_NUM_COLS;
+                    uint8_t y = NEO_TRELLIS_Y(key) + (padBoard / cols) * NEO_TRELLIS_NUM_ROWS;
+                    keyEvent evt;
+                    evt.reg = 0;
+                    evt.bit.EDGE = raw[i].bit.EDGE;
+                    evt.bit.NUM  = y * X_DIM + x;
+                    keyPress(evt);
+                }
+            }
+        }
+
+        if (++padBoard >= boards) {
+            padBoard = 0;
+            trellisTimer = 0;
+        }
     }
 
     TrellisCallback keyPress(keyEvent evt) {
@@ -590,6 +562,8 @@ namespace Input {
             if (pressed) {
                 activeTrack = padToTrack(key);                     // select track
                 Sequencer::setCurrentTrack(activeTrack); 
+                Params::applyTrack(activeTrack);        // recall the track's sound
+                refreshEncoderLabels();
                 updateTrackLEDs();                      // light only the selected track
                 shiftModeActive = true;                 // enable shift LED mode
             }
@@ -659,7 +633,44 @@ namespace Input {
         // F1 ENGINE ID
         if (f1Active && key >= 20 && key < 24 && pressed) {
             if (!pressed) return;
-            //Sequencer::assignTrackToEngine(key-20);
+            Sequencer::assignTrackToEngine(key-20);
+            return;
+        }
+        // F1 WAVEFORM of the last sample played on the track
+        if (f1Active && key == 24 && pressed) {
+            if (WaveView::isActive() && Display::getPage() == Display::PAGE_SAMPLE) {
+                WaveView::hide();
+            } else {
+                WaveView::show(AudioEngine::lastSampleOnTrack(Sequencer::getCurrentTrack()));
+            }
+            return;
+        }
+        // F1 CLEAR CLIP flags on all meters
+        if (f1Active && key == 25 && pressed) {
+            AudioEngine::clearClips();
+            return;
+        }
+        // F1 ARP LATCH
+        if (f1Active && key == 27 && pressed) {
+            Sequencer::setArpLatch(!Sequencer::arpLatch);
+            return;
+        }
+        // F1 GROOVE: extract from this track / apply the last one to it
+        if (f1Active && key == 28 && pressed) {
+            Groove::extract(Sequencer::getCurrentTrack());
+            return;
+        }
+        if (f1Active && key == 29 && pressed) {
+            Groove::assign(Sequencer::getCurrentTrack(), Groove::lastExtracted());
+            return;
+        }
+        // F1 OVERVIEW of all tracks
+        if (f1Active && key == 26 && pressed) {
+            if (Overview::isActive() && Display::getPage() == Display::PAGE_OVERVIEW) {
+                Overview::hide();
+            } else {
+                Overview::show();
+            }
             return;
         }
         // ---------- Normal pad behavior ----------
@@ -684,7 +695,7 @@ namespace Input {
             AudioEngine::pushPending(trk, note, 0);
 
         if (Sequencer::isRecording)
-            Sequencer::recordNoteEvent(trk, note, pressed ? Sequencer::getDefaultVelocity() : 0);
+            Sequencer::recordNoteEventAt(trk, note, pressed ? Sequencer::getDefaultVelocity() : 0, e.cycles);
 
         trellisDirty = true;
     }
@@ -759,14 +770,138 @@ namespace Input {
         trellisDirty = true;
     }
 
-    void processTrellisLEDs() {
+    // One NeoTrellis board per call, so a full refresh never holds the bus
+    // for more than one board's pixels
+    static void showTrellisBoard() {
         static elapsedMillis ledTimer;
+        static uint8_t boardsPending = 0;   // bit per board
+        constexpr uint8_t boards = (Y_DIM / 4) * (X_DIM / 4);
 
-        if (trellisDirty && ledTimer >= 5) {
-            trellis.show();      // must call show() to update hardware
+        if (!boardsPending) {
+            if (!trellisDirty || ledTimer < 5) return;
             trellisDirty = false;
+            boardsPending = (1 << boards) - 1;
             ledTimer = 0;
         }
+
+        uint8_t b = __builtin_ctz(boardsPending);
+        t_array[b / (X_DIM / 4)][b % (X_DIM / 4)].pixels.show();   // must call show() to update hardware
+        boardsPending &= ~(1 << b);
+    }
+
+    // ----------------------------------------------------------------------------------//
+    //                                  I2C SCHEDULER                                    //
+    // ----------------------------------------------------------------------------------//
+    // Pads and the encoder board share Wire1 and every Wire call blocks, so
+    // each loop() pass gets at most one device read or write: pads first,
+    // then one encoder stage, then one pad board's LEDs. Devices with a
+    // wired INT line are read only while it is asserted, the rest are polled.
+    #define ENC_STAGE_IDLE 0xFF
+    static uint8_t encStage = ENC_STAGE_IDLE;   // 0 = buttons, 1..NUM_ENCODERS = positions
+
+    static bool padsPending() {
+        if (padCount) return padWait >= TRELLIS_FIFO_WAIT_US;
+        if (padBoard) return true;
+        if (TRELLIS_INT_PIN != NO_INT_PIN) return digitalReadFast(TRELLIS_INT_PIN) == LOW;
+        return trellisTimer > TRELLIS_INTERVAL;
+    }
+
+    static bool encodersPending() {
+        if (ENC_INT_PIN != NO_INT_PIN) return digitalReadFast(ENC_INT_PIN) == LOW;
+        return encTimer > ENC_INTERVAL;
+    }
+
+    void serviceI2C() {
+        if (padsPending()) {
+            readPads();
+            return;
+        }
+
+        if (encStage == ENC_STAGE_IDLE && encodersPending()) encStage = 0;
+        if (encStage != ENC_STAGE_IDLE) {
+            if (encStage == 0) readEncoderButtons();
+            else               readEncoderPosition(encStage - 1);
+
+            if (++encStage > NUM_ENCODERS) {
+                encStage = ENC_STAGE_IDLE;
+                encTimer = 0;
+            }
+            return;
+        }
+
+        showTrellisBoard();
+    }
+
+    // ----------------------------------------------------------------------------------//
+    //                                  TOUCHSCREEN                                      //
+    // ----------------------------------------------------------------------------------//
+    struct TouchBinding {
+        uint8_t page;
+        uint8_t component;
+        TouchCallback callback;
+    };
+
+    static TouchBinding touchBindings[MAX_TOUCH_BINDINGS];
+    static uint8_t numTouchBindings = 0;
+    static char lastDisplayText[DISPLAY_RX_TEXT + 1];
+
+    bool bindTouch(uint8_t page, uint8_t component, TouchCallback callback) {
+        if (numTouchBindings >= MAX_TOUCH_BINDINGS) return false;
+        touchBindings[numTouchBindings++] = { page, component, callback };
+        return true;
+    }
+
+    // Called from Display::pump(), turns panel frames into input events
+    void onDisplayRx(const Display::RxEvent &rx) {
+        InputEvent e = {};
+        switch (rx.type) {
+            case Display::RxType::TOUCH:
+                e.type  = rx.pressed ? InputEventType::TOUCH_PRESS : InputEventType::TOUCH_RELEASE;
+                e.id    = rx.component;
+                e.delta = rx.page;
+                break;
+            case Display::RxType::PAGE:
+                e.type = InputEventType::PAGE_CHANGE;
+                e.id   = rx.page;
+                break;
+            case Display::RxType::NUMBER:
+                e.type  = InputEventType::DISPLAY_NUMBER;
+                e.delta = rx.number;
+                break;
+            case Display::RxType::STRING:
+                strncpy(lastDisplayText, rx.text, DISPLAY_RX_TEXT);
+                lastDisplayText[DISPLAY_RX_TEXT] = 0;
+                e.type = InputEventType::DISPLAY_STRING;
+                break;
+        }
+        pushInputEvent(e);
+    }
+
+    void handleDisplayEvent(const InputEvent &e) {
+        switch (e.type) {
+            case InputEventType::TOUCH_PRESS:
+            case InputEventType::TOUCH_RELEASE: {
+                bool pressed = e.type == InputEventType::TOUCH_PRESS;
+                for (uint8_t i = 0; i < numTouchBindings; i++) {
+                    const TouchBinding &b = touchBindings[i];
+                    if (b.page == e.delta && b.component == e.id) {
+                        b.callback(pressed);
+                        return;
+                    }
+                }
+                break;                          // unbound component
+            }
+            case InputEventType::PAGE_CHANGE:
+                // Page opened from the panel itself
+                f6Active = (e.id == Display::PAGE_DIAG);
+                if (e.id == Display::PAGE_MAIN) Sequencer::redrawPage();
+                break;
+            // Replies to get requests; none are issued yet, so they are dropped
+            case InputEventType::DISPLAY_NUMBER:
+            case InputEventType::DISPLAY_STRING:
+            default:
+                break;
+        }
     }
 
     // ---------------- PROCESS  ----------------
@@ -779,11 +914,24 @@ namespace Input {
                     handlePadEvent(e);
                     break;
 
+                case InputEventType::BUTTON_PRESS:
+                case InputEventType::BUTTON_RELEASE:
+                    manager.dispatch(e.id, e.type == InputEventType::BUTTON_PRESS);
+                    break;
+
                 case InputEventType::ENC_TURN:
                 case InputEventType::ENC_PRESS:
                 case InputEventType::ENC_RELEASE:
                     handleEncoderEvent(e);
                     break;
+
+                case InputEventType::TOUCH_PRESS:
+                case InputEventType::TOUCH_RELEASE:
+                case InputEventType::PAGE_CHANGE:
+                case InputEventType::DISPLAY_NUMBER:
+                case InputEventType::DISPLAY_STRING:
+                    handleDisplayEvent(e);
+                    break;
             }
         }
     }
@@ -830,10 +978,23 @@ namespace Input {
         //encPos[4]=encB.getEncoderPosition(0); encPos[5]=encB.getEncoderPosition(1);
         //encPos[6]=encB.getEncoderPosition(1); encPos[7]=encB.getEncoderPosition(3);
 
+        // TOUCHSCREEN
+        Display::setRxHandler(onDisplayRx);
+
+        // Fast turns update the value labels at most every 30 ms
+        for (int i = 0; i < NUM_ENCODERS; i++)
+            Display::setWidgetInterval(encNames[i], 30);
+
         encA.enableEncoderInterrupt(0); encA.enableEncoderInterrupt(1);
         encA.enableEncoderInterrupt(2); encA.enableEncoderInterrupt(3);
         //encB.enableEncoderInterrupt(0); encB.enableEncoderInterrupt(1);
         //encB.enableEncoderInterrupt(2); encB.enableEncoderInterrupt(3);
+        uint32_t encButtonMask = 0;
+        for (int i = 0; i < NUM_ENCODERS; i++) encButtonMask |= (1UL << encPins[i]);
+        encA.setGPIOInterrupts(encButtonMask, true);
+
+        if (TRELLIS_INT_PIN != NO_INT_PIN) pinMode(TRELLIS_INT_PIN, INPUT_PULLUP);
+        if (ENC_INT_PIN != NO_INT_PIN)     pinMode(ENC_INT_PIN, INPUT_PULLUP);
 
         //pixels.begin(); pixels.setBrightness(255); pixels.show();
 
@@ -57,7 +57,6 @@ namespace Input {
     extern Adafruit_seesaw* encBoards[];
     extern const char* encNames[];
 
-    void readEncoders();
     void setEncoderPage(uint8_t page);
 
     // ---------------- BUTTONPADS ----------------
@@ -66,12 +65,21 @@ namespace Input {
     extern Adafruit_NeoTrellis t_array[Y_DIM/4][X_DIM/4];
     extern Adafruit_MultiTrellis trellis;
     uint8_t keyToNote(uint8_t keyIndex);
-    void readPads();
     TrellisCallback keyPress();
-    void processTrellisLEDs();
     void clearAllTrackLEDs();
     void updateTrackLEDs();
 
+    // ---------------- TOUCHSCREEN ----------------
+    #define MAX_TOUCH_BINDINGS 32
+    typedef void (*TouchCallback)(bool pressed);
+    bool bindTouch(uint8_t page, uint8_t component, TouchCallback callback);
+
+    // ---------------- I2C ----------------
+    #define NO_INT_PIN      255
+    #define TRELLIS_INT_PIN NO_INT_PIN  // NeoTrellis INT (open drain), polled when not wired
+    #define ENC_INT_PIN     NO_INT_PIN  // encoder board INT
+    void serviceI2C();              // one Wire1 transaction per call
+
     // ---------------- PROCESS  ----------------
     void processInputEvents();
     
@@ -110,6 +110,13 @@
     #include "Sequencer.h"
     #include "Input.h"
     #include "Display.h"
+    #include "AudioGovernor.h"
+    #include "WaveView.h"
+    #include "Meters.h"
+    #include "Overview.h"
+    #include "Params.h"
+    #include "Automation.h"
+    #include "Groove.h"
 
     // ---SETUP---
     void setup() {
@@ -119,27 +126,37 @@
         Display::init(Serial6, 921600, 10);
         delay(200);
         Display::writeStr("load.txt", "X");
+        Display::flush();
 
+        Params::init();
+        Automation::init();
+        Groove::init();
         Input::init(); 
         delay(200);
         Display::writeStr("load.txt", "XX");
+        Display::flush();
 
         AudioEngine::init();
+        AudioGovernor::init();
         delay(200);
         Display::writeStr("load.txt", "XXX");
+        Display::flush();
 
         Sequencer::init();
         delay(200);
         Display::writeStr("load.txt", "XXXX");
+        Display::flush();
 
         //SD.begin(AudioEngine::SDCARD_CS_PIN);
         AudioEngine::loadAndAssignPad("Kick_V.raw", 1);
+        //AudioEngine::benchmarkSampler();
 
         delay(200);
         Display::writeStr("load.txt", "XXXXX");
+        Display::flush();
         Serial.println("ALL INITIALIZED");
         delay(200);
-        Display::writeCmd("page 1");
+        Display::setPage(Display::PAGE_MAIN);
         delay(200);
 
         Sequencer::initView(2);
@@ -163,16 +180,18 @@
     void loop() {
 
       AudioEngine::processAudio();
+      AudioGovernor::process();
       Sequencer::processDisplay();
+      WaveView::process();
+      Overview::process();
+      Meters::process();
 
       Input::mainEncoder();
-      Input::readPads();
-      Input::readEncoders();
+      Input::serviceI2C();
       
       Input::processInputEvents();
-      Input::processTrellisLEDs();
-      
-      //Display.NextionListen();
+
+      Display::pump();
 
     }
 
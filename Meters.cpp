@@ -0,0 +1,93 @@
+#include "Meters.h"
+#include "AudioEngine.h"
+#include "Display.h"
+#include "Sequencer.h"
+
+namespace Meters {
+
+    static constexpr uint16_t barY = METER_Y + METER_CLIP_H + 2;
+    static constexpr uint16_t barH = METER_H - METER_CLIP_H - 2;
+
+    struct MeterState {
+        uint16_t rms;       // drawn heights in pixels
+        uint16_t peak;
+        bool     clip;
+        bool     valid;     // false = nothing drawn yet
+    };
+
+    enum { METER_TRACK = 0, METER_MASTER, NUM_METERS };
+
+    static MeterState meters[NUM_METERS];
+    static elapsedMillis frameTimer;
+    static uint8_t lastPage = 0xFF;
+
+    void invalidate() {
+        for (uint8_t m = 0; m < NUM_METERS; m++) meters[m].valid = false;
+    }
+
+    static inline uint16_t toPixels(float level) {
+        if (level >= 1.0f) return barH;
+        return (uint16_t)(level * barH + 0.5f);
+    }
+
+    // Height h is measured from the bottom of the bar
+    static void fillBar(uint16_t x, uint16_t from, uint16_t to, uint16_t color) {
+        if (to <= from) return;
+        Display::Cmd("fill").num(x).num(barY + barH - to).num(METER_W).num(to - from)
+                            .num(color).send();
+    }
+
+    static void drawMeter(uint8_t m, const LevelReading &level) {
+        MeterState &s = meters[m];
+        uint16_t x = METER_X + m * (METER_W + METER_SPACING);
+
+        uint16_t rms  = toPixels(level.rms);
+        uint16_t peak = toPixels(level.peak);
+        if (s.valid && peak < s.peak)
+            peak = max(peak, (uint16_t)(s.peak > METER_FALL_PX ? s.peak - METER_FALL_PX : 0));
+        if (peak < rms) peak = rms;
+
+        if (!s.valid || level.clip != s.clip) {
+            Display::Cmd("fill").num(x).num(METER_Y).num(METER_W).num(METER_CLIP_H)
+                                .num(level.clip ? Colors::clip : Colors::idle).send();
+            s.clip = level.clip;        // the bar below may be unchanged
+        }
+
+        if (!s.valid) {
+            fillBar(x, 0, rms, Colors::rms);
+            fillBar(x, rms, barH, Colors::bg);
+        } else if (rms != s.rms || peak != s.peak) {
+            // Repaint only the span between the old and new bar tops, up to
+            // the old or new marker, whichever is higher
+            uint16_t lo = min(rms, s.rms);
+            uint16_t hi = min((uint16_t)(max(peak, s.peak) + METER_MARK_H), barH);
+            fillBar(x, lo, rms, Colors::rms);
+            fillBar(x, rms, hi, Colors::bg);
+        } else {
+            return;
+        }
+        if (peak > rms) fillBar(x, peak, min((uint16_t)(peak + METER_MARK_H), barH), Colors::peak);
+
+        s.rms   = rms;
+        s.peak  = peak;
+        s.valid = true;
+    }
+
+    void process() {
+        if (frameTimer < METER_FRAME_MS) return;
+        frameTimer = 0;
+
+        AudioEngine::readMeters();      // windows close at the publish rate
+
+        uint8_t page = Display::getPage();
+        if (page != lastPage) {
+            lastPage = page;
+            invalidate();
+        }
+        if (page != Display::PAGE_MAIN) return;
+
+        drawMeter(METER_TRACK,  AudioEngine::getTrackLevel(Sequencer::getCurrentTrack()));
+        drawMeter(METER_MASTER, AudioEngine::getMasterLevel());
+    }
+
+} // namespace Meters
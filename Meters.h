@@ -0,0 +1,34 @@
+#ifndef METERS_H
+#define METERS_H
+
+#include <Arduino.h>
+
+namespace Meters {
+
+    // ------------------ CONFIG ------------------
+    #define METER_FRAME_MS    33    // ~30 Hz publish rate
+    #define METER_X          668    // right of the grid
+    #define METER_Y          121
+    #define METER_W           16
+    #define METER_H          240    // clip box + bar
+    #define METER_SPACING      8
+    #define METER_CLIP_H       8
+    #define METER_MARK_H       2    // peak marker
+    #define METER_FALL_PX      6    // peak marker fall per frame
+
+    namespace Colors {
+        constexpr uint16_t bg   = 0;
+        constexpr uint16_t rms  = 2016;     // green
+        constexpr uint16_t peak = 65504;    // yellow
+        constexpr uint16_t clip = 63488;    // red
+        constexpr uint16_t idle = 12678;    // grey clip box
+    }
+
+    // Current track and master bars on the main page. RMS is drawn as the
+    // bar, peak as a falling marker; only the pixels that moved are sent.
+    void process();                 // call from loop()
+    void invalidate();              // redraw everything on the next frame
+
+} // namespace Meters
+
+#endif
@@ -0,0 +1,158 @@
+#include "Overview.h"
+#include "Display.h"
+
+namespace Overview {
+
+    static uint32_t stepBits[MAX_TRACKS][OV_STEP_WORDS];     // note-on per step
+    static uint32_t drawnBits[MAX_TRACKS][OV_STEP_WORDS];    // as on screen
+    static bool     drawnMute[MAX_TRACKS];
+
+    static uint32_t rowsPending  = 0;       // bit per track
+    static uint16_t layoutSteps  = 0;       // total steps at the last full redraw
+    static int8_t   markedTrack  = -1;
+    static bool     active       = false;
+    static bool     clearPending = false;
+
+    static elapsedMillis frameTimer;
+
+    static inline bool bitAt(const uint32_t* bits, uint16_t step) {
+        return bits[step >> 5] & (1UL << (step & 31));
+    }
+
+    static inline uint16_t rowY(uint8_t track) {
+        return OV_Y + track * (OV_ROW_H + OV_ROW_GAP);
+    }
+
+    static void buildStepBits(uint8_t track) {
+        uint32_t* bits = stepBits[track];
+        memset(bits, 0, sizeof(stepBits[track]));
+
+        const Sequencer::Pattern &p = Sequencer::curSeq().tracks[track].pattern;
+        if (!p.events) return;
+
+        const uint16_t total = Sequencer::getTotalSteps();
+        for (uint16_t i = 0; i < p.count; i++) {
+            const Sequencer::Event &e = p.events[i];
+            if (e.type != Sequencer::EventType::NOTE_ON) continue;
+            uint32_t step = e.tick / TICKS_PER_STEP;
+            if (step < total) bits[step >> 5] |= (1UL << (step & 31));
+        }
+    }
+
+    // First step at or after from whose bit differs from on. Whole words of
+    // the same value are skipped.
+    static uint16_t runEnd(const uint32_t* bits, uint16_t from, uint16_t to, bool on) {
+        const uint32_t same = on ? 0xFFFFFFFF : 0;
+        uint16_t s = from;
+        while (s < to) {
+            if ((s & 31) == 0 && s + 32 <= to && bits[s >> 5] == same) {
+                s += 32;
+                continue;
+            }
+            if (bitAt(bits, s) != on) break;
+            s++;
+        }
+        return s;
+    }
+
+    // Steps [from, to) of one row, one fill per run of equal steps
+    static void drawRowSpan(uint8_t track, uint16_t from, uint16_t to, uint16_t stepPx) {
+        const uint16_t onColor = Sequencer::curSeq().tracks[track].mute ? Colors::muted : Colors::on;
+        const uint32_t* bits = stepBits[track];
+
+        uint16_t s = from;
+        while (s < to) {
+            bool on = bitAt(bits, s);
+            uint16_t e = runEnd(bits, s, to, on);
+            Display::Cmd("fill").num(OV_X + s * stepPx).num(rowY(track))
+                                .num((e - s) * stepPx).num(OV_ROW_H)
+                                .num(on ? onColor : Colors::bg).send();
+            s = e;
+        }
+    }
+
+    // Redraws the part of a row that differs from what was last sent
+    static void drawRow(uint8_t track, uint16_t total, uint16_t stepPx) {
+        const bool muted = Sequencer::curSeq().tracks[track].mute;
+        int16_t first = -1, last = -1;
+
+        if (muted != drawnMute[track]) {
+            first = 0;
+            last  = total - 1;
+        } else {
+            for (uint16_t w = 0; w < (total + 31) / 32; w++) {
+                uint32_t diff = stepBits[track][w] ^ drawnBits[track][w];
+                if (!diff) continue;
+                if (first < 0) first = w * 32 + __builtin_ctz(diff);
+                last = w * 32 + 31 - __builtin_clz(diff);
+            }
+        }
+
+        if (first >= 0) drawRowSpan(track, first, min((uint16_t)(last + 1), total), stepPx);
+        memcpy(drawnBits[track], stepBits[track], sizeof(drawnBits[track]));
+        drawnMute[track] = muted;
+    }
+
+    static void drawMarker(int8_t track, uint16_t color) {
+        if (track < 0) return;
+        Display::Cmd("fill").num(OV_X - OV_MARK_W - 2).num(rowY(track))
+                            .num(OV_MARK_W).num(OV_ROW_H).num(color).send();
+    }
+
+    void show() {
+        active = true;
+        clearPending = true;
+        Display::setPage(Display::PAGE_OVERVIEW);
+    }
+
+    void hide() {
+        if (!active) return;
+        active = false;
+        Display::setPage(Display::PAGE_MAIN);
+        Sequencer::redrawPage();
+    }
+
+    bool isActive() { return active; }
+
+    void process() {
+        if (!active || Display::getPage() != Display::PAGE_OVERVIEW) return;
+        if (frameTimer < DISPLAY_FRAME_MS) return;
+        frameTimer = 0;
+        elapsedMicros frameTime;
+
+        const uint16_t total  = Sequencer::getTotalSteps();
+        const uint16_t stepPx = max(OV_W / total, 1);
+
+        uint32_t edits = Sequencer::takeTrackEdits();
+
+        if (clearPending || total != layoutSteps) {
+            clearPending = false;
+            layoutSteps  = total;
+            Display::Cmd("fill").num(OV_X - OV_MARK_W - 2).num(OV_Y)
+                                .num(OV_W + OV_MARK_W + 2).num(rowY(MAX_TRACKS) - OV_Y)
+                                .num(Colors::bg).send();
+            memset(drawnBits, 0, sizeof(drawnBits));
+            memset(drawnMute, 0, sizeof(drawnMute));
+            markedTrack = -1;
+            edits = 0xFFFFFFFF;
+        }
+
+        for (uint8_t t = 0; t < MAX_TRACKS; t++)
+            if (edits & (1UL << t)) buildStepBits(t);
+        rowsPending |= edits;
+
+        int8_t current = Sequencer::getCurrentTrack();
+        if (current != markedTrack) {
+            drawMarker(markedTrack, Colors::bg);
+            drawMarker(current, Colors::mark);
+            markedTrack = current;
+        }
+
+        while (rowsPending && Display::frameBudgetLeft(frameTime)) {
+            uint8_t t = __builtin_ctz(rowsPending);
+            drawRow(t, total, stepPx);
+            rowsPending &= ~(1UL << t);
+        }
+    }
+
+} // namespace Overview
@@ -0,0 +1,35 @@
+#ifndef OVERVIEW_H
+#define OVERVIEW_H
+
+#include <Arduino.h>
+#include "Sequencer.h"
+
+namespace Overview {
+
+    // ------------------ CONFIG ------------------
+    #define OV_X          X_OFFSET
+    #define OV_Y              60
+    #define OV_W          DISPLAY_PIXELS
+    #define OV_ROW_H           8
+    #define OV_ROW_GAP         2
+    #define OV_MARK_W          4    // current track marker, left of the rows
+    #define OV_STEP_WORDS  (MAX_PATTERN_STEPS / 32)
+
+    namespace Colors {
+        constexpr uint16_t bg    = 0;
+        constexpr uint16_t on    = 65535;
+        constexpr uint16_t muted = 21130;
+        constexpr uint16_t mark  = 2016;
+    }
+
+    // All tracks x all steps on PAGE_OVERVIEW. Each track keeps a step
+    // bitmap; an edited track is rebuilt and only the span of steps that
+    // differs from the screen is resent, as one fill per run.
+    void show();
+    void hide();                    // back to the sequencer page
+    bool isActive();
+    void process();                 // call from loop()
+
+} // namespace Overview
+
+#endif
@@ -0,0 +1,189 @@
+#include "Params.h"
+#include "AudioEngine.h"
+#include "Sequencer.h"
+#include "Groove.h"
+
+namespace Params {
+
+    // ------------------ APPLY ------------------
+    static void applySynth(uint8_t trackId, EncParam id, float value) {
+        AudioEngine::setSynthParam(trackId, id, value);
+    }
+
+    static inline bool isEnvelope(EncParam id) {
+        return id == EncParam::ENV_ATT || id == EncParam::ENV_DEC ||
+               id == EncParam::ENV_SUS || id == EncParam::ENV_REL;
+    }
+
+    static void applyArp(uint8_t, EncParam id, float value) {
+        switch (id) {
+            case EncParam::ARP_RATE:    Sequencer::arpRate    = (Sequencer::TimingDivision)(int)value; break;
+            case EncParam::ARP_OCTAVES: Sequencer::arpOctaves = (uint8_t)value; break;
+            case EncParam::ARP_MODE:    Sequencer::setArpMode((Sequencer::ArpMode)(int)value); break;
+            case EncParam::ARP_GATE:    Sequencer::arpGate    = value; break;
+            default: return;
+        }
+        Sequencer::recalcArpTiming();
+    }
+
+    static void applyGroove(uint8_t trackId, EncParam, float value) {
+        Groove::setSwing(trackId, (uint8_t)value);
+    }
+
+    static void applyMain(uint8_t, EncParam id, float value) {
+        AudioEngine::setMainParam(id, value);
+    }
+
+    // ------------------ REGISTRY ------------------
+    static const ParamDef registry[] = {
+        //  id                          min    max   step   curve          default  scale            accel  perTrack apply
+        { EncParam::FILTER_CUTOFF,     20,    8000, 0.01f, Curve::EXP,    2000,    100.0f / 8000,   50.0f, true,  applySynth },
+        { EncParam::FILTER_RESONANCE,  0,     4,    0.05f, Curve::LINEAR, 0.7f,    100.0f / 4,      50.0f, true,  applySynth },
+        { EncParam::BITCRUSH_BITS,     4,     16,   1,     Curve::LINEAR, 8,       1.0f,            50.0f, true,  applySynth },
+        { EncParam::OSC1_PULSE,        0,     3,    1,     Curve::LINEAR, 0.5f,    100.0f / 4,      50.0f, true,  applySynth },
+
+        { EncParam::ENV_ATT,           0,     1000, 10,    Curve::LINEAR, 0,       100.0f / 1000,   10.0f, true,  applySynth },
+        { EncParam::ENV_DEC,           0,     1000, 10,    Curve::LINEAR, 10,      100.0f / 1000,   10.0f, true,  applySynth },
+        { EncParam::ENV_SUS,           0,     1,    0.01f, Curve::LINEAR, 1.0f,    100.0f,          10.0f, true,  applySynth },
+        { EncParam::ENV_REL,           0,     2000, 10,    Curve::LINEAR, 20,      100.0f / 2000,   10.0f, true,  applySynth },
+
+        { EncParam::ARP_RATE,          0,     5,    1,     Curve::LINEAR, 2,       1.0f,            10.0f, false, applyArp   },
+        { EncParam::ARP_OCTAVES,       1,     4,    1,     Curve::LINEAR, 2,       1.0f,            10.0f, false, applyArp   },
+        { EncParam::ARP_MODE,          0,     6,    1,     Curve::LINEAR, 1,       1.0f,            10.0f, false, applyArp   },
+        { EncParam::ARP_GATE,          0.1f,  1.0f, 0.05f, Curve::LINEAR, 0.8f,    100.0f,          10.0f, false, applyArp   },
+
+        { EncParam::MAIN_VOL,          0,     1,    0.05f, Curve::LINEAR, 0.5f,    100.0f,          10.0f, false, applyMain  },
+        { EncParam::SWING,             50,    75,   1,     Curve::LINEAR, 50,      1.0f,            10.0f, true,  applyGroove},
+        { EncParam::MAIN_3,            0,     100,  1,     Curve::LINEAR, 0,       1.0f,            10.0f, false, applyMain  },
+        { EncParam::MAIN_4,            0,     100,  1,     Curve::LINEAR, 0,       1.0f,            10.0f, false, applyMain  },
+    };
+    static constexpr uint8_t REGISTRY_SIZE = sizeof(registry) / sizeof(registry[0]);
+
+    const ParamPage pages[NUM_PARAM_PAGES] = {
+        { "SYNTH",  { EncParam::FILTER_CUTOFF, EncParam::FILTER_RESONANCE, EncParam::BITCRUSH_BITS, EncParam::OSC1_PULSE } },
+        { "ADSR",   { EncParam::ENV_ATT,       EncParam::ENV_DEC,          EncParam::ENV_SUS,       EncParam::ENV_REL    } },
+        { "ARP",    { EncParam::ARP_RATE,      EncParam::ARP_OCTAVES,      EncParam::ARP_MODE,      EncParam::ARP_GATE   } },
+        { "GLOBAL", { EncParam::MAIN_VOL,      EncParam::SWING,            EncParam::MAIN_3,        EncParam::MAIN_4     } },
+    };
+
+    static int8_t registryIndex[PARAM_COUNT];        // EncParam -> registry, -1 = unregistered
+    static float  values[MAX_TRACKS][PARAM_COUNT];   // global parameters live in row 0
+
+    const ParamDef* find(EncParam id) {
+        uint8_t i = (uint8_t)id;
+        if (i >= PARAM_COUNT || registryIndex[i] < 0) return nullptr;
+        return &registry[registryIndex[i]];
+    }
+
+    static inline float& slot(const ParamDef &d, uint8_t trackId) {
+        return values[d.perTrack ? trackId : 0][(uint8_t)d.id];
+    }
+
+    float get(uint8_t trackId, EncParam id) {
+        const ParamDef* d = find(id);
+        if (!d || trackId >= MAX_TRACKS) return 0.0f;
+        return slot(*d, trackId);
+    }
+
+    void set(uint8_t trackId, EncParam id, float value) {
+        const ParamDef* d = find(id);
+        if (!d || trackId >= MAX_TRACKS) return;
+        value = constrain(value, d->minVal, d->maxVal);
+        slot(*d, trackId) = value;
+        if (d->apply) d->apply(trackId, id, value);
+    }
+
+    // Faster turns take bigger steps, up to maxAccel times the base step
+    static float computeAccel(uint32_t dt, float maxAccel) {
+        if (dt == 0) dt = 1;  // avoid divide by zero
+
+        // normalized speed: smaller dt = faster turn
+        float speed = 100.0f / float(dt);
+        speed = constrain(speed, 0.0f, maxAccel);
+
+        // exponential curve: 1.0 → maxAccel
+        float accel = 1.0f + pow(speed, 2.0f);
+        return constrain(accel, 1.0f, maxAccel);
+    }
+
+    float nudge(uint8_t trackId, EncParam id, int32_t delta, uint32_t dtMs) {
+        const ParamDef* d = find(id);
+        if (!d || trackId >= MAX_TRACKS) return 0.0f;
+
+        float accel = computeAccel(dtMs, d->maxAccel);
+        // Fine scaling for small ranges
+        if ((d->maxVal - d->minVal) < 10.0f) {
+            float speed = (dtMs > 0) ? 1.0f / float(dtMs) : 0.0f;
+            accel = 1.0f + speed;   // less aggressive
+        }
+
+        float v = slot(*d, trackId);
+        if (d->curve == Curve::EXP) {
+            // Move along log(value), so each detent is the same musical step
+            float span = logf(d->maxVal / d->minVal);
+            float pos  = logf(max(v, d->minVal) / d->minVal) / span;
+            pos = constrain(pos + delta * d->step * accel, 0.0f, 1.0f);
+            v = d->minVal * expf(pos * span);
+        } else {
+            v += delta * d->step * accel;
+        }
+
+        set(trackId, id, v);
+        return slot(*d, trackId);
+    }
+
+    int32_t displayValue(EncParam id, float value) {
+        const ParamDef* d = find(id);
+        if (!d) return 0;
+        return (int32_t)roundf(value * d->displayScale);
+    }
+
+    void applyValue(uint8_t trackId, EncParam id, float value) {
+        const ParamDef* d = find(id);
+        if (!d || !d->apply || trackId >= MAX_TRACKS) return;
+        d->apply(trackId, id, constrain(value, d->minVal, d->maxVal));
+    }
+
+    uint8_t toNormalized(EncParam id, float value) {
+        const ParamDef* d = find(id);
+        if (!d) return 0;
+        value = constrain(value, d->minVal, d->maxVal);
+        float pos = (d->curve == Curve::EXP)
+                  ? logf(value / d->minVal) / logf(d->maxVal / d->minVal)
+                  : (value - d->minVal) / (d->maxVal - d->minVal);
+        return (uint8_t)roundf(pos * 127.0f);
+    }
+
+    float fromNormalized(EncParam id, uint8_t n) {
+        const ParamDef* d = find(id);
+        if (!d) return 0.0f;
+        float pos = min(n, (uint8_t)127) / 127.0f;
+        if (d->curve == Curve::EXP) return d->minVal * expf(pos * logf(d->maxVal / d->minVal));
+        return d->minVal + pos * (d->maxVal - d->minVal);
+    }
+
+    // Engines shared by tracks are not stored per engine: the selected
+    // track's values win until another track is selected or edited
+    void applyTrack(uint8_t trackId) {
+        if (trackId >= MAX_TRACKS) return;
+        const bool sampler = (Sequencer::TrackType)Sequencer::curSeq().tracks[trackId].type
+                             == Sequencer::TrackType::SAMPLER;
+        for (uint8_t r = 0; r < REGISTRY_SIZE; r++) {
+            const ParamDef &d = registry[r];
+            if (!d.perTrack || !d.apply) continue;
+            if (sampler && d.apply == applySynth && !isEnvelope(d.id)) continue;
+            d.apply(trackId, d.id, slot(d, trackId));
+        }
+    }
+
+    void init() {
+        for (uint8_t i = 0; i < PARAM_COUNT; i++) registryIndex[i] = -1;
+        for (uint8_t r = 0; r < REGISTRY_SIZE; r++)
+            registryIndex[(uint8_t)registry[r].id] = r;
+
+        for (uint8_t t = 0; t < MAX_TRACKS; t++)
+            for (uint8_t r = 0; r < REGISTRY_SIZE; r++)
+                slot(registry[r], t) = registry[r].defaultVal;
+    }
+
+} // namespace Params
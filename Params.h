@@ -0,0 +1,58 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+namespace Params {
+
+    // ------------------ CONFIG ------------------
+    #define PARAM_COUNT      ((uint8_t)EncParam::MAIN_4 + 1)
+    #define PARAM_PAGE_SLOTS 4      // one parameter per encoder
+    #define NUM_PARAM_PAGES  4
+
+    enum class Curve : uint8_t {
+        LINEAR,     // step in value units
+        EXP         // step as a fraction of the range, for frequencies
+    };
+
+    typedef void (*ApplyFn)(uint8_t trackId, EncParam id, float value);
+
+    struct ParamDef {
+        EncParam id;
+        float    minVal;
+        float    maxVal;
+        float    step;
+        Curve    curve;
+        float    defaultVal;
+        float    displayScale;  // e.g. 100 for %, 1 for raw
+        float    maxAccel;
+        bool     perTrack;      // false = one value shared by all tracks
+        ApplyFn  apply;         // pushes a value into the engine
+    };
+
+    struct ParamPage {
+        const char* name;
+        EncParam    slots[PARAM_PAGE_SLOTS];
+    };
+
+    extern const ParamPage pages[NUM_PARAM_PAGES];
+
+    // Values are stored per track (global parameters in one shared slot),
+    // so they can be recalled on track change, saved and automated.
+    const ParamDef* find(EncParam id);
+    float   get(uint8_t trackId, EncParam id);
+    void    set(uint8_t trackId, EncParam id, float value);     // clamp, store, apply
+    float   nudge(uint8_t trackId, EncParam id, int32_t delta, uint32_t dtMs);
+    int32_t displayValue(EncParam id, float value);
+    void    applyTrack(uint8_t trackId);    // pushes a track's values to its engine, on select
+    void    applyValue(uint8_t trackId, EncParam id, float value);  // apply without storing
+
+    // 0..127 across the range, following the curve (locks and lanes)
+    uint8_t toNormalized(EncParam id, float value);
+    float   fromNormalized(EncParam id, uint8_t n);
+    void    init();
+
+} // namespace Params
+
+#endif
@@ -0,0 +1,516 @@
+#include "PatternEdit.h"
+
+namespace PatternEdit {
+
+    using Sequencer::Event;
+    using Sequencer::Pattern;
+    using Sequencer::MAX_EVENTS_PER_PATTERN;
+
+    enum class OpKind : uint8_t { INSERT, REMOVE, MODIFY };
+
+    // One primitive edit. INSERT / REMOVE hold the event itself; MODIFY
+    // holds the other version, swapped with the pattern on undo and redo.
+    struct Op {
+        OpKind   kind;
+        uint8_t  seq;
+        uint8_t  track;
+        uint16_t index;
+        Event    ev;
+    };
+    static_assert(sizeof(Op) == 16, "JOURNAL_OPS sizing assumes 16-byte ops");
+
+    struct Step {
+        uint32_t first;             // absolute op numbers, ops[n % JOURNAL_OPS]
+        uint32_t last;              // one past
+    };
+
+    static DMAMEM Op ops[JOURNAL_OPS];
+    static Step steps[JOURNAL_STEPS];
+
+    // Ops [opTail, opHead) are live. Steps [firstStep, cursor) can be
+    // undone, [cursor, lastStep) redone.
+    static volatile uint32_t opTail = 0, opHead = 0;
+    static uint32_t firstStep = 0, cursor = 0, lastStep = 0;
+    static uint32_t openFirst = 0;      // first op of the open step
+    static volatile uint8_t depth = 0;
+    static volatile bool openEmpty = false;
+    static volatile bool overflow = false;
+
+    static inline Step& stepAt(uint32_t n) { return steps[n % JOURNAL_STEPS]; }
+
+    static void dropOldestStep() {
+        opTail = stepAt(firstStep).last;
+        firstStep++;
+    }
+
+    void reset() {
+        noInterrupts();
+        opTail = openFirst = opHead;
+        firstStep = cursor = lastStep = 0;
+        openEmpty = true;
+        overflow = false;
+        interrupts();
+    }
+
+    // ------------------ RECORDING ------------------
+    void begin() {
+        if (depth++ > 0) return;
+        noInterrupts();
+        openEmpty = true;
+        overflow = false;
+        interrupts();
+    }
+
+    void end() {
+        if (depth == 0 || --depth > 0) return;
+
+        noInterrupts();
+        if (openEmpty) {
+            // nothing changed, history and the redo branch stay
+        } else if (overflow) {
+            // Older steps no longer line up with the pattern
+            opTail = opHead;
+            firstStep = cursor = lastStep = 0;
+            overflow = false;
+        } else {
+            if (lastStep - firstStep == JOURNAL_STEPS) dropOldestStep();
+            stepAt(lastStep) = { openFirst, opHead };
+            cursor = ++lastStep;
+        }
+        interrupts();
+    }
+
+    bool isOpen() { return depth > 0; }
+
+    static uint8_t trackOf(const Pattern &p) {
+        Sequencer::Sequence &s = Sequencer::curSeq();
+        for (uint8_t t = 0; t < MAX_TRACKS; t++)
+            if (&s.tracks[t].pattern == &p) return t;
+        return 0xFF;
+    }
+
+    static void push(OpKind kind, const Pattern &p, uint16_t index, const Event &e) {
+        if (depth == 0 || overflow) return;
+        uint8_t track = trackOf(p);
+        if (track == 0xFF) return;
+
+        // The step's first edit ends the redo branch
+        if (openEmpty) {
+            openEmpty = false;
+            lastStep = cursor;
+            opHead = (cursor > firstStep) ? stepAt(cursor - 1).last : opTail;
+            openFirst = opHead;
+        }
+
+        if (opHead - opTail == JOURNAL_OPS) {
+            if (firstStep == cursor) {  // the open step alone fills the journal
+                overflow = true;
+                return;
+            }
+            dropOldestStep();
+        }
+        Op &op = ops[opHead % JOURNAL_OPS];
+        op.kind  = kind;
+        op.seq   = Sequencer::currentSequence;
+        op.track = track;
+        op.index = index;
+        op.ev    = e;
+        opHead++;
+    }
+
+    void logInsert(const Pattern &p, uint16_t index, const Event &e)      { push(OpKind::INSERT, p, index, e); }
+    void logRemove(const Pattern &p, uint16_t index, const Event &e)      { push(OpKind::REMOVE, p, index, e); }
+    void logModify(const Pattern &p, uint16_t index, const Event &before) { push(OpKind::MODIFY, p, index, before); }
+
+    // ------------------ REPLAY ------------------
+    // Raw edits at a journaled index, bypassing the journal and the sort
+    static void insertAt(Sequencer::Track &tr, uint16_t index, const Event &e) {
+        if (!tr.pattern.events) Sequencer::initPattern(tr);
+        Pattern &p = tr.pattern;
+        if (!p.events || p.count >= p.maxEvents || index > p.count) return;
+        noInterrupts();
+        memmove(&p.events[index + 1], &p.events[index], (p.count - index) * sizeof(Event));
+        p.events[index] = e;
+        p.count++;
+        interrupts();
+    }
+
+    static void removeAt(Sequencer::Track &tr, uint16_t index) {
+        Pattern &p = tr.pattern;
+        if (!p.events || index >= p.count) return;
+        noInterrupts();
+        memmove(&p.events[index], &p.events[index + 1], (p.count - index - 1) * sizeof(Event));
+        p.count--;
+        interrupts();
+    }
+
+    static void swapAt(Sequencer::Track &tr, uint16_t index, Event &e) {
+        Pattern &p = tr.pattern;
+        if (!p.events || index >= p.count) return;
+        noInterrupts();
+        Event cur = p.events[index];
+        p.events[index] = e;
+        interrupts();
+        e = cur;
+    }
+
+    static void apply(Op &op, bool forward) {
+        Sequencer::Track &tr = Sequencer::sequences[op.seq].tracks[op.track];
+        switch (op.kind) {
+            case OpKind::INSERT:
+                if (forward) insertAt(tr, op.index, op.ev); else removeAt(tr, op.index);
+                break;
+            case OpKind::REMOVE:
+                if (forward) removeAt(tr, op.index); else insertAt(tr, op.index, op.ev);
+                break;
+            case OpKind::MODIFY:
+                swapAt(tr, op.index, op.ev);
+                break;
+        }
+        if (op.seq == Sequencer::currentSequence) Sequencer::markTrackEdited(op.track);
+    }
+
+    bool undo() {
+        if (depth > 0 || cursor == firstStep) return false;
+        Step &s = stepAt(--cursor);
+        for (uint32_t n = s.last; n-- > s.first; ) apply(ops[n % JOURNAL_OPS], false);
+        Sequencer::refreshStepFlags();
+        return true;
+    }
+
+    bool redo() {
+        if (depth > 0 || cursor == lastStep) return false;
+        Step &s = stepAt(cursor++);
+        for (uint32_t n = s.first; n < s.last; n++) apply(ops[n % JOURNAL_OPS], true);
+        Sequencer::refreshStepFlags();
+        return true;
+    }
+
+    bool canUndo() { return depth == 0 && cursor != firstStep; }
+    bool canRedo() { return depth == 0 && cursor != lastStep; }
+
+    // ------------------ RANGE OPS ------------------
+    // A range selects the notes that start in it, each with its note-off
+    // wherever that lies, and the controls in it. Note-offs of notes that
+    // started earlier are not selected and stay put.
+    static DMAMEM Event clip[MAX_EVENTS_PER_PATTERN];
+    static DMAMEM Event work[MAX_EVENTS_PER_PATTERN];      // events to merge in
+    static DMAMEM Event merged[MAX_EVENTS_PER_PATTERN];
+    static int16_t  pairOf[MAX_EVENTS_PER_PATTERN];         // note-on <-> note-off, -1 = none
+    static int16_t  clipPair[MAX_EVENTS_PER_PATTERN];
+    static uint32_t selected[MAX_EVENTS_PER_PATTERN / 32];
+    static uint16_t clipCount  = 0;
+    static uint32_t clipLength = 0;                         // ticks
+
+    uint16_t clipboardCount() { return clipCount; }
+
+    static inline bool isSelected(uint16_t i) { return selected[i / 32] & (1UL << (i % 32)); }
+    static inline void select(uint16_t i)     { selected[i / 32] |= (1UL << (i % 32)); }
+
+    // Pairs each note-on with the next note-off of its pitch. A note still
+    // open at the pattern end closes on the first off of its pitch after the
+    // wrap; a retrigger leaves the earlier note without an off.
+    static void pairNotes(const Event* ev, uint16_t count, int16_t* pair) {
+        int16_t open[128];
+        memset(open, 0xFF, sizeof(open));
+        for (uint16_t i = 0; i < count; i++) pair[i] = -1;
+
+        for (uint16_t i = 0; i < count; i++) {
+            const Event &e = ev[i];
+            if (e.type == Sequencer::EventType::CC) continue;
+            uint8_t n = e.note & 0x7F;
+            if (e.type == Sequencer::EventType::NOTE_ON) {
+                open[n] = i;
+            } else if (open[n] >= 0) {
+                pair[i] = open[n];
+                pair[open[n]] = i;
+                open[n] = -1;
+            }
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            const Event &e = ev[i];
+            if (e.type == Sequencer::EventType::CC) continue;
+            uint8_t n = e.note & 0x7F;
+            if (open[n] < 0) continue;
+            if (e.type == Sequencer::EventType::NOTE_OFF && pair[i] < 0 && open[n] > (int16_t)i) {
+                pair[i] = open[n];
+                pair[open[n]] = i;
+            }
+            open[n] = -1;                   // only the first event of the pitch counts
+        }
+    }
+
+    // Note length in ticks, across the loop for wrapped notes
+    static inline uint32_t noteLength(const Event &on, const Event &off, uint32_t len) {
+        return (off.tick + len - on.tick) % len;
+    }
+
+    struct Range { uint16_t lo, hi; };
+
+    static bool rangeOf(const Pattern &p, uint32_t &startTick, uint32_t &endTick, Range &r) {
+        endTick = min(endTick, Sequencer::getMaxTicks());
+        if (!p.events || startTick >= endTick) return false;
+        r.lo = Sequencer::lowerBound(p, startTick);
+        r.hi = Sequencer::lowerBound(p, endTick);
+        return true;
+    }
+
+    // Marks the range's notes with their offs, and its controls
+    static void selectRange(const Pattern &p, const Range &r) {
+        memset(selected, 0, sizeof(selected));
+        if (!p.events) return;
+        pairNotes(p.events, p.count, pairOf);
+        for (uint16_t i = r.lo; i < r.hi; i++) {
+            Sequencer::EventType t = p.events[i].type;
+            if (t == Sequencer::EventType::NOTE_OFF) continue;
+            select(i);
+            if (t == Sequencer::EventType::NOTE_ON && pairOf[i] >= 0) select(pairOf[i]);
+        }
+    }
+
+    static void sortWork(uint16_t n) {
+        Pattern sorted = {};
+        sorted.events    = work;
+        sorted.count     = n;
+        sorted.maxEvents = MAX_EVENTS_PER_PATTERN;
+        Sequencer::sortPattern(sorted);
+    }
+
+    static void finishEdit(uint8_t trackId) {
+        Sequencer::markTrackEdited(trackId);
+        Sequencer::refreshStepFlags();
+    }
+
+    // Removes the selected events and merges work[0..n), which must be
+    // sorted, into the rest. New events go after existing ones on equal
+    // keys, as with insertEvent; what does not fit is dropped. Removals are
+    // journaled top down and inserts at their final index, so replay holds.
+    // The clock also writes while recording, so this runs with interrupts off.
+    static bool replaceSelected(uint8_t trackId, uint16_t n) {
+        Sequencer::Track &tr = Sequencer::curSeq().tracks[trackId];
+        if (!tr.pattern.events) {
+            Sequencer::initPattern(tr);
+            memset(selected, 0, sizeof(selected));
+        }
+        Pattern &p = tr.pattern;
+        if (!p.events) return false;
+
+        begin();
+        noInterrupts();
+        uint16_t keep = 0;
+        for (uint16_t i = p.count; i-- > 0; ) {
+            if (isSelected(i)) logRemove(p, i, p.events[i]);
+            else keep++;
+        }
+        if (keep + n > p.maxEvents) n = p.maxEvents - keep;
+
+        uint16_t a = 0, b = 0, out = 0;
+        while (a < p.count || b < n) {
+            while (a < p.count && isSelected(a)) a++;
+            const Event *kept = (a < p.count) ? &p.events[a] : nullptr;
+            if (!kept && b >= n) break;
+            if (b < n && (!kept || Sequencer::eventBefore(work[b], *kept))) {
+                merged[out] = work[b++];
+                logInsert(p, out, merged[out]);
+            } else {
+                merged[out] = *kept;
+                a++;
+            }
+            out++;
+        }
+        memcpy(p.events, merged, out * sizeof(Event));
+        p.count = out;
+        interrupts();
+        end();
+
+        finishEdit(trackId);
+        return true;
+    }
+
+    // Offs keep their note's length, so they may lie past the range end
+    bool copy(uint8_t trackId, uint32_t startTick, uint32_t endTick) {
+        if (trackId >= MAX_TRACKS) return false;
+        const Pattern &p = Sequencer::curSeq().tracks[trackId].pattern;
+        Range r;
+        if (!rangeOf(p, startTick, endTick, r)) return false;
+        selectRange(p, r);
+
+        const uint32_t len = Sequencer::getMaxTicks();
+        uint16_t n = 0;
+        for (uint16_t i = r.lo; i < r.hi; i++) {
+            const Event &e = p.events[i];
+            if (!isSelected(i) || e.type == Sequencer::EventType::NOTE_OFF) continue;
+            clip[n] = e;
+            clip[n++].tick = e.tick - startTick;
+            if (e.type == Sequencer::EventType::NOTE_ON && pairOf[i] >= 0) {
+                clip[n] = p.events[pairOf[i]];
+                clip[n++].tick = e.tick - startTick + noteLength(e, p.events[pairOf[i]], len);
+            }
+        }
+
+        Pattern sorted = {};
+        sorted.events    = clip;
+        sorted.count     = n;
+        sorted.maxEvents = MAX_EVENTS_PER_PATTERN;
+        Sequencer::sortPattern(sorted);
+        pairNotes(clip, n, clipPair);
+
+        clipCount  = n;
+        clipLength = endTick - startTick;
+        return true;
+    }
+
+    // Clipboard repeated from startTick, replacing the notes and controls
+    // of [startTick, endTick). Notes starting past endTick are dropped with
+    // their offs; an off past the pattern end closes on its last tick.
+    static bool tile(uint8_t trackId, uint32_t startTick, uint32_t endTick) {
+        if (trackId >= MAX_TRACKS || clipLength == 0) return false;
+        const Pattern &p = Sequencer::curSeq().tracks[trackId].pattern;
+        const uint32_t maxTicks = Sequencer::getMaxTicks();
+        endTick = min(endTick, maxTicks);
+        if (startTick >= endTick) return false;
+
+        uint16_t n = 0;
+        for (uint32_t base = startTick; base < endTick; base += clipLength) {
+            for (uint16_t i = 0; i < clipCount && n < MAX_EVENTS_PER_PATTERN; i++) {
+                Event e = clip[i];
+                e.tick += base;
+                if (e.type == Sequencer::EventType::NOTE_OFF) {
+                    if (clipPair[i] >= 0 && base + clip[clipPair[i]].tick >= endTick) continue;
+                    if (e.tick >= maxTicks) e.tick = maxTicks - 1;
+                } else if (e.tick >= endTick) {
+                    continue;
+                }
+                work[n++] = e;
+            }
+        }
+        sortWork(n);                        // clamped offs and overlapping repeats
+
+        Range r = { 0, 0 };
+        if (p.events) {
+            r.lo = Sequencer::lowerBound(p, startTick);
+            r.hi = Sequencer::lowerBound(p, endTick);
+        }
+        selectRange(p, r);
+        return replaceSelected(trackId, n);
+    }
+
+    bool paste(uint8_t trackId, uint32_t atTick) {
+        return tile(trackId, atTick, atTick + clipLength);
+    }
+
+    bool duplicate(uint8_t trackId, uint32_t startTick, uint32_t endTick) {
+        if (!copy(trackId, startTick, endTick)) return false;
+        return tile(trackId, startTick, Sequencer::getMaxTicks());
+    }
+
+    // In place: pitch is not part of the event order
+    bool transpose(uint8_t trackId, uint32_t startTick, uint32_t endTick, int8_t semitones) {
+        if (trackId >= MAX_TRACKS) return false;
+        Pattern &p = Sequencer::curSeq().tracks[trackId].pattern;
+        Range r;
+        if (!rangeOf(p, startTick, endTick, r)) return false;
+        selectRange(p, r);
+
+        begin();
+        noInterrupts();
+        for (uint16_t i = 0; i < p.count; i++) {
+            Event &e = p.events[i];
+            if (!isSelected(i) || e.type == Sequencer::EventType::CC) continue;   // note is a control id
+            logModify(p, i, e);
+            e.note = constrain((int16_t)e.note + semitones, 0, 127);
+        }
+        interrupts();
+        end();
+
+        finishEdit(trackId);
+        return true;
+    }
+
+    bool scaleVelocity(uint8_t trackId, uint32_t startTick, uint32_t endTick, float factor) {
+        if (trackId >= MAX_TRACKS) return false;
+        Pattern &p = Sequencer::curSeq().tracks[trackId].pattern;
+        Range r;
+        if (!rangeOf(p, startTick, endTick, r)) return false;
+
+        begin();
+        noInterrupts();
+        for (uint16_t i = r.lo; i < r.hi; i++) {
+            Event &e = p.events[i];
+            if (e.type != Sequencer::EventType::NOTE_ON) continue;
+            logModify(p, i, e);
+            e.value = constrain((int16_t)(e.value * factor + 0.5f), 1, 127);
+        }
+        interrupts();
+        end();
+
+        finishEdit(trackId);
+        return true;
+    }
+
+    bool shift(uint8_t trackId, uint32_t startTick, uint32_t endTick, int32_t ticks) {
+        if (trackId >= MAX_TRACKS) return false;
+        const Pattern &p = Sequencer::curSeq().tracks[trackId].pattern;
+        Range r;
+        if (!rangeOf(p, startTick, endTick, r)) return false;
+
+        const int32_t len = Sequencer::getMaxTicks();
+        ticks %= len;
+        if (ticks == 0) return true;
+        selectRange(p, r);
+
+        // The selection is sorted and moves by one amount, so the shifted
+        // events form two sorted runs split where they wrap; the run that
+        // lands early in the pattern goes first
+        uint16_t n = 0;
+        for (uint8_t pass = 0; pass < 2; pass++) {
+            for (uint16_t i = 0; i < p.count; i++) {
+                if (!isSelected(i)) continue;
+                int32_t t = (int32_t)p.events[i].tick + ticks;
+                bool wrapped = (t < 0 || t >= len);
+                if (wrapped != ((ticks > 0) == (pass == 0))) continue;
+                work[n] = p.events[i];
+                work[n++].tick = (t + len) % len;
+            }
+        }
+        return replaceSelected(trackId, n);
+    }
+
+    // Notes are mirrored as spans, so each keeps its velocity; one running
+    // past the range end is cut there. Controls mirror by step.
+    bool reverse(uint8_t trackId, uint32_t startTick, uint32_t endTick) {
+        if (trackId >= MAX_TRACKS) return false;
+        const Pattern &p = Sequencer::curSeq().tracks[trackId].pattern;
+        Range r;
+        if (!rangeOf(p, startTick, endTick, r)) return false;
+        selectRange(p, r);
+
+        const uint32_t len    = Sequencer::getMaxTicks();
+        const uint32_t mirror = startTick + endTick;
+        uint16_t n = 0;
+        for (uint16_t i = r.hi; i-- > r.lo && n < MAX_EVENTS_PER_PATTERN - 1; ) {
+            const Event &e = p.events[i];
+            if (e.type == Sequencer::EventType::CC) {
+                int32_t t = (int32_t)mirror - TICKS_PER_STEP - (int32_t)e.tick;
+                work[n] = e;
+                work[n++].tick = max(t, (int32_t)startTick);
+            } else if (e.type == Sequencer::EventType::NOTE_ON) {
+                uint32_t offTick = endTick;
+                if (pairOf[i] >= 0) {
+                    offTick = min(e.tick + noteLength(e, p.events[pairOf[i]], len), endTick);
+                } else {
+                    for (uint16_t j = i + 1; j < r.hi; j++) {       // cut by a retrigger
+                        if (p.events[j].type != Sequencer::EventType::NOTE_ON || p.events[j].note != e.note) continue;
+                        offTick = p.events[j].tick;
+                        break;
+                    }
+                }
+                work[n++] = Sequencer::makeEvent(mirror - offTick, e.note, e.value);
+                work[n++] = Sequencer::makeEvent(min(mirror - e.tick, len - 1), e.note, 0);
+            }
+        }
+        sortWork(n);
+        return replaceSelected(trackId, n);
+    }
+
+} // namespace PatternEdit
@@ -0,0 +1,51 @@
+#ifndef PATTERNEDIT_H
+#define PATTERNEDIT_H
+
+#include <Arduino.h>
+#include "Sequencer.h"
+
+namespace PatternEdit {
+
+    // ------------------ CONFIG ------------------
+    #define JOURNAL_OPS    2048     // 16 bytes each, shared by all undo steps
+    #define JOURNAL_STEPS    32     // undo levels kept
+
+    // Edits between begin() and end() form one undo step; calls nest, so a
+    // record pass that clears the pattern and records into it is one step.
+    // While a step is open, Sequencer::insertEvent / removeEvent journal
+    // their inverse; outside one, edits are not undoable.
+    void begin();
+    void end();
+    bool isOpen();
+
+    // Called by the pattern primitives with interrupts off
+    void logInsert(const Sequencer::Pattern &p, uint16_t index, const Sequencer::Event &e);
+    void logRemove(const Sequencer::Pattern &p, uint16_t index, const Sequencer::Event &e);
+    void logModify(const Sequencer::Pattern &p, uint16_t index, const Sequencer::Event &before);
+
+    // Refused while a step is open (recording)
+    bool undo();
+    bool redo();
+    bool canUndo();
+    bool canRedo();
+    void reset();                   // drops all history
+
+    // ------------------ RANGE OPS ------------------
+    // Ranges are [startTick, endTick) on a track of the current sequence,
+    // bounded by binary search and rewritten in one merge pass. A range
+    // takes the notes starting in it together with their note-offs, and
+    // its controls; offs of notes started earlier stay where they are.
+    // Each call is one undo step. The clipboard holds events in pattern
+    // format with ticks relative to the copied range.
+    bool copy(uint8_t trackId, uint32_t startTick, uint32_t endTick);
+    bool paste(uint8_t trackId, uint32_t atTick);       // replaces the clipboard's length
+    bool duplicate(uint8_t trackId, uint32_t startTick, uint32_t endTick);     // repeats to the pattern end
+    bool transpose(uint8_t trackId, uint32_t startTick, uint32_t endTick, int8_t semitones);
+    bool scaleVelocity(uint8_t trackId, uint32_t startTick, uint32_t endTick, float factor);
+    bool shift(uint8_t trackId, uint32_t startTick, uint32_t endTick, int32_t ticks);  // wraps
+    bool reverse(uint8_t trackId, uint32_t startTick, uint32_t endTick);
+    uint16_t clipboardCount();
+
+} // namespace PatternEdit
+
+#endif
@@ -1,5 +1,9 @@
 #include "Sequencer.h"
 #include "Display.h"
+#include "Meters.h"
+#include "Automation.h"
+#include "PatternEdit.h"
+#include "Groove.h"
 
 #define ATOMIC(X) noInterrupts(); X; interrupts();
 
@@ -34,6 +38,66 @@ namespace Sequencer {
         patternSlotUsed[slot] = false;
     }
 
+    // First event at or after tick
+    uint16_t lowerBound(const Pattern &p, uint32_t tick) {
+        uint16_t lo = 0, hi = p.count;
+        while (lo < hi) {
+            uint16_t mid = (lo + hi) / 2;
+            if (p.events[mid].tick < tick) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Atomic against the clock interrupt, which reads and also records
+    bool insertEvent(Pattern &p, const Event &e) {
+        if (!p.events) return false;
+
+        noInterrupts();
+        if (p.count >= p.maxEvents) {
+            interrupts();
+            return false;
+        }
+        uint16_t lo = 0, hi = p.count;
+        while (lo < hi) {
+            uint16_t mid = (lo + hi) / 2;
+            if (eventBefore(e, p.events[mid])) hi = mid;
+            else lo = mid + 1;
+        }
+        memmove(&p.events[lo + 1], &p.events[lo], (p.count - lo) * sizeof(Event));
+        p.events[lo] = e;
+        p.count++;
+        PatternEdit::logInsert(p, lo, e);
+        interrupts();
+        return true;
+    }
+
+    bool removeEvent(Pattern &p, uint16_t index) {
+        noInterrupts();
+        if (index >= p.count) {
+            interrupts();
+            return false;
+        }
+        PatternEdit::logRemove(p, index, p.events[index]);
+        memmove(&p.events[index], &p.events[index + 1], (p.count - index - 1) * sizeof(Event));
+        p.count--;
+        interrupts();
+        return true;
+    }
+
+    // Insertion sort, stable; patterns are nearly sorted when this is needed
+    void sortPattern(Pattern &p) {
+        for (uint16_t i = 1; i < p.count; i++) {
+            Event e = p.events[i];
+            uint16_t j = i;
+            while (j > 0 && eventBefore(e, p.events[j - 1])) {
+                p.events[j] = p.events[j - 1];
+                j--;
+            }
+            p.events[j] = e;
+        }
+    }
+
     //--- TRACK --- //
     const char* trackTypeToStr(uint8_t type) {
         switch(type) {
@@ -60,6 +124,20 @@ namespace Sequencer {
     }
 
 
+    // Voices already sounding on the old engine are released; the engine
+    // graph itself is static, so this is safe during playback.
+    void assignTrackToEngine(uint8_t engine) {
+        uint8_t t = getCurrentTrack();
+        if (t >= MAX_TRACKS || engine >= MAX_ENGINES) return;
+
+        Track &trk = curSeq().tracks[t];
+        if (trk.engine == engine) return;
+
+        AudioEngine::muteTrack(t);
+        trk.engine = engine;
+        Display::writeNum("neng.val", engine + 1);
+    }
+
     void setCurrentTrack(uint8_t t) {
         if (t >= MAX_TRACKS) return;
         currentTrack = t;
@@ -67,6 +145,7 @@ namespace Sequencer {
 
         Display::writeNum("ntrack.val", currentTrack + 1);
         Display::writeStr("ttrack.txt", trackTypeToStr(tr.type));
+        Display::writeNum("neng.val", tr.engine + 1);
 
         // Auto-create track if not active
         if (!tr.active) {
@@ -100,6 +179,7 @@ namespace Sequencer {
         if (tr.mute) {
             AudioEngine::muteTrack(track);
         }
+        markTrackEdited(track);
         uint32_t color = tr.mute ? 65535 : 33808;
         Display::writeNum("mute.pco", color);
     }
@@ -165,6 +245,8 @@ namespace Sequencer {
 
     // TRANSPORT
     volatile uint32_t playheadTick = 0;  // current tick within pattern
+    static volatile uint32_t lastTickCycles = 0;    // ARM_DWT_CYCCNT when playheadTick last moved
+    static uint16_t playCursor[MAX_TRACKS];         // next event to play, per track
     volatile uint32_t tickOffset = 0;    // offset to align playhead after preroll
 
     bool isPlaying = false;
@@ -174,7 +256,21 @@ namespace Sequencer {
     uint32_t prerollTick = 0;
     bool prerollActive = false;
 
-    bool viewportRedrawPending = true;
+    volatile bool viewportRedrawPending = true;
+    static volatile uint32_t trackEditMask = 0xFFFFFFFF;
+
+    void markTrackEdited(uint8_t track) {
+        if (track >= MAX_TRACKS) return;
+        ATOMIC(trackEditMask |= (1UL << track));
+    }
+
+    uint32_t takeTrackEdits() {
+        noInterrupts();
+        uint32_t mask = trackEditMask;
+        trackEditMask = 0;
+        interrupts();
+        return mask;
+    }
     TransportState transport = STOPPED;
 
     static constexpr uint8_t PREROLL_BEATS = 4;
@@ -334,31 +430,87 @@ namespace Sequencer {
     // ARPEGGIATOR
     TimingDivision arpRate = TimingDivision::EIGHTH;
     uint8_t numHeldNotes = 0;
-    ArpVoice arpVoice = { false, false, 0, 0, 0 };
+    ArpVoice arpVoice;
     ArpMode arpMode = ArpMode::OFF;
     float arpGate = 0.8f;
+    bool arpLatch = false;
+    uint8_t arpOctaves = 3;       // octave cycle range
+
+    // Held note pool, in press order
+    static constexpr uint8_t MAX_HELD_NOTES = MAX_ARP_VOICES;
+    static uint8_t heldNotes[MAX_HELD_NOTES];
+    static uint8_t numPressed = 0;          // pads physically down
+
+    // Note order for the current mode, held set and octave range, rebuilt
+    // when any of them changes; the clock only indexes it. CHORD stores
+    // one entry per octave, the lowest chord note.
+    static uint8_t arpSeq[MAX_ARP_SEQ];
+    static volatile uint8_t arpSeqLen = 0;
+    static uint8_t arpChord[MAX_HELD_NOTES];   // held set, sorted
+    static volatile uint8_t arpChordLen = 0;
+
+    void rebuildArpSequence() {
+        uint8_t sorted[MAX_HELD_NOTES];
+        uint8_t n = numHeldNotes;
+        memcpy(sorted, heldNotes, n);
+        for (uint8_t i = 1; i < n; i++) {
+            uint8_t v = sorted[i], j = i;
+            while (j > 0 && sorted[j - 1] > v) { sorted[j] = sorted[j - 1]; j--; }
+            sorted[j] = v;
+        }
+
+        uint8_t seq[MAX_ARP_SEQ];
+        uint8_t len = 0;
+        uint8_t octaves = constrain(arpOctaves, 1, MAX_ARP_OCTAVES);
+        const uint8_t* src = (arpMode == ArpMode::AS_PLAYED) ? heldNotes : sorted;
+
+        if (arpMode == ArpMode::CHORD) {
+            for (uint8_t o = 0; o < octaves && n; o++) seq[len++] = sorted[0] + o * 12;
+        } else {
+            for (uint8_t o = 0; o < octaves; o++)
+                for (uint8_t i = 0; i < n; i++)
+                    if (src[i] + o * 12 <= 127) seq[len++] = src[i] + o * 12;
+
+            if (arpMode == ArpMode::DOWN) {
+                for (uint8_t i = 0; i < len / 2; i++) {
+                    uint8_t t = seq[i]; seq[i] = seq[len - 1 - i]; seq[len - 1 - i] = t;
+                }
+            } else if (arpMode == ArpMode::UP_DOWN && len > 2) {
+                // Top and bottom play once per cycle
+                for (uint8_t i = len - 1; i-- > 1; ) seq[len + (len - 2 - i)] = seq[i];
+                len = len * 2 - 2;
+            }
+        }
+
+        noInterrupts();
+        memcpy(arpSeq, seq, len);
+        arpSeqLen = len;
+        memcpy(arpChord, sorted, n);
+        arpChordLen = n;
+        interrupts();
+    }
 
     void recalcArpTiming() {
-        // This function can precompute interval ticks if needed
+        rebuildArpSequence();   // octave range or mode may have changed
     }
-    static constexpr uint8_t MAX_ARP_VOICES = 1; // monophonic arp output
-    uint8_t arpOctaves = 3;       // octave cycle range
 
     void setArpMode(ArpMode mode) {
         arpMode = mode;
         const char* txt = "OFF";
         switch(mode) {
-            case ArpMode::UP_OCTAVE:  txt = "UP"; break;
-            case ArpMode::HELD_NOTES: txt = "HLD"; break;
-            case ArpMode::OFF:         txt = "OFF"; break;
+            case ArpMode::UP:        txt = "UP";  break;
+            case ArpMode::DOWN:      txt = "DN";  break;
+            case ArpMode::UP_DOWN:   txt = "UD";  break;
+            case ArpMode::RANDOM:    txt = "RND"; break;
+            case ArpMode::AS_PLAYED: txt = "PLY"; break;
+            case ArpMode::CHORD:     txt = "CHD"; break;
+            case ArpMode::OFF:       txt = "OFF"; break;
         }
         Display::writeStr("arp.txt", txt);
+        if (mode == ArpMode::OFF) resetArp();
+        else rebuildArpSequence();
     }
 
-    // Held note pool
-    static constexpr uint8_t MAX_HELD_NOTES = 8;
-    static uint8_t heldNotes[MAX_HELD_NOTES];
-
     void addHeldNote(uint8_t note) {
         for (uint8_t i = 0; i < numHeldNotes; i++)
             if (heldNotes[i] == note) return; // already in pool
@@ -377,140 +529,127 @@ namespace Sequencer {
         }
     }
 
+    static void releaseArpNotes() {
+        for (uint8_t i = 0; i < arpVoice.numOn; i++) {
+            AudioEngine::noteOff(arpVoice.trackId, arpVoice.notes[i]);
+            if (isRecording)
+                recordNoteEvent(arpVoice.trackId, arpVoice.notes[i], 0); // track-aware
+        }
+        arpVoice.numOn  = 0;
+        arpVoice.noteOn = false;
+    }
+
+    void resetArp() {
+        arpVoice.active = false;        // the clock leaves the voice alone
+        releaseArpNotes();
+        numHeldNotes = 0;
+        numPressed   = 0;
+        rebuildArpSequence();
+    }
+
+    void setArpLatch(bool on) {
+        arpLatch = on;
+        if (!on && numPressed == 0) resetArp();
+    }
+
     void startArp(uint8_t note) {
         if (arpMode == ArpMode::OFF)
             return;
-        uint8_t curTrackId = Sequencer::getCurrentTrack(); // latch current track
 
-        addHeldNote(note);
+        // An arp with an empty set only runs out its last gate. It is
+        // scheduled before the new set is built, so the clock cannot step
+        // on the stale grid in between.
+        if (!arpVoice.active || arpSeqLen == 0) {
+            const uint8_t track = getCurrentTrack();
+            if (arpVoice.noteOn && arpVoice.trackId != track) {
+                arpVoice.active = false;        // released on the track they were played on
+                releaseArpNotes();
+            }
 
-        if (arpVoice.active)
-            return;
+            // First step on the next grid line of the arp rate
+            uint32_t interval = divisionToTicks(arpRate);
+            uint32_t tick;
+            ATOMIC(tick = playheadTick);
+            noInterrupts();
+            arpVoice.stepIndex = 0;
+            arpVoice.nextTick  = interval ? ((tick + interval - 1) / interval) * interval : tick;
+            if (!arpVoice.noteOn) arpVoice.offTick = 0;
+            arpVoice.trackId   = track;              // latch current track
+            arpVoice.active    = true;
+            interrupts();
+        }
 
-        arpVoice.active    = true;
-        arpVoice.noteOn    = false;
-        arpVoice.stepIndex = 0;
-        arpVoice.nextTick  = playheadTick;  // start immediately
-        arpVoice.offTick   = 0;
-        arpVoice.trackId  = curTrackId; 
+        // A latched set is replaced by the next chord played
+        if (arpLatch && numPressed == 0) numHeldNotes = 0;
+        numPressed++;
+        addHeldNote(note);
+        rebuildArpSequence();
     }
 
+    // Sounding notes run out their gate; the next step reads the new order.
+    // Once the set is empty nothing steps, and processArp still releases
+    // the last notes at their off tick.
     void stopArp(uint8_t note) {
-        removeHeldNote(note);
+        if (numPressed) numPressed--;
+        if (arpLatch) return;
 
-        // If the currently playing note is related to this released note, stop it
-        if (arpVoice.noteOn) {
-            bool stillValid = false;
-
-            for (uint8_t i = 0; i < numHeldNotes; i++) {
-                if (arpMode == ArpMode::UP_OCTAVE) {
-                    uint8_t base = heldNotes[0];
-                    for (uint8_t o = 0; o < arpOctaves; o++) {
-                        if (arpVoice.note == base + o * 12) {
-                            stillValid = true;
-                            break;
-                        }
-                    }
-                } else { // HELD_NOTES
-                    if (arpVoice.note == heldNotes[i]) {
-                        stillValid = true;
-                    }
-                }
-                if (stillValid) break;
-            }
-
-            if (!stillValid) {
-                AudioEngine::noteOff(arpVoice.trackId, arpVoice.note);
-                arpVoice.noteOn = false;
-
-                if (isRecording)
-                    recordNoteEvent(arpVoice.trackId, arpVoice.note, 0); // track-aware
-            }
-        }
+        removeHeldNote(note);
+        rebuildArpSequence();
     }
 
-    // --- Get next arp note based on mode ---
-    uint8_t getNextArpNote(uint8_t step) {
-        if (numHeldNotes == 0) return 0; // sanity
-
-        switch (arpMode) {
-            case ArpMode::UP_OCTAVE: {
-                uint8_t baseNote = heldNotes[0];
-                uint8_t octave    = step % arpOctaves;
-                return baseNote + octave * 12;
-            }
-            case ArpMode::HELD_NOTES:
-                return heldNotes[step % numHeldNotes];
-            default:
-                return 0;
-        }
+    static uint32_t arpRandom() {
+        static uint32_t x = 0x1234567;
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        return x;
     }
 
     void processArp(uint32_t tick) {
-        if (!arpVoice.active || numHeldNotes == 0 || arpMode == ArpMode::OFF)
+        if (!arpVoice.active || arpMode == ArpMode::OFF)
             return;
 
         uint32_t interval = divisionToTicks(arpRate);
         if (interval == 0) return;
 
-        // --- check currently playing note ---
-        if (arpVoice.noteOn) {
-            bool stillHeld = false;
-            for (uint8_t i = 0; i < numHeldNotes; i++) {
-                uint8_t expectedNote = (arpMode == ArpMode::UP_OCTAVE) ? getNextArpNote(arpVoice.stepIndex-1) 
-                                                                    : heldNotes[i];
-                if (arpVoice.note == expectedNote) {
-                    stillHeld = true;
-                    break;
-                }
-            }
-            if (!stillHeld) {
-                AudioEngine::noteOff(arpVoice.trackId, arpVoice.note);
-                arpVoice.noteOn = false;
-            }
-        }
+        // --- NOTE OFF ---
+        if (arpVoice.noteOn && tick >= arpVoice.offTick) releaseArpNotes();
 
         // --- NOTE ON ---
-        if (!arpVoice.noteOn && tick >= arpVoice.nextTick) {
-            if (numHeldNotes == 0) {
-                arpVoice.active = false;
-                return;
+        if (tick < arpVoice.nextTick || arpSeqLen == 0) return;
+        if (arpVoice.noteOn) releaseArpNotes();         // gate >= 1: legato
+
+        uint8_t len = arpSeqLen;
+        uint8_t idx = (arpMode == ArpMode::RANDOM) ? arpRandom() % len : arpVoice.stepIndex % len;
+        uint8_t vel = getDefaultVelocity();
+
+        if (arpMode == ArpMode::CHORD) {
+            int16_t shift = arpSeq[idx] - arpChord[0];
+            for (uint8_t i = 0; i < arpChordLen; i++) {
+                int16_t n = arpChord[i] + shift;
+                if (n > 127) break;
+                arpVoice.notes[arpVoice.numOn++] = n;
             }
-
-            uint8_t noteToPlay = getNextArpNote(arpVoice.stepIndex);
-
-            AudioEngine::noteOn(arpVoice.trackId, noteToPlay, getDefaultVelocity());
-            arpVoice.note = noteToPlay;
-            arpVoice.noteOn = true;
-
-            arpVoice.offTick = tick + (uint32_t)(interval * arpGate);
-            arpVoice.nextTick = tick + interval;
-            arpVoice.stepIndex++;
-
-            if (isRecording)
-                recordNoteEvent(arpVoice.trackId, noteToPlay, getDefaultVelocity());
+        } else {
+            arpVoice.notes[arpVoice.numOn++] = arpSeq[idx];
         }
 
-        // --- NOTE OFF ---
-        if (arpVoice.noteOn && tick >= arpVoice.offTick) {
-            AudioEngine::noteOff(arpVoice.trackId, arpVoice.note);
-            arpVoice.noteOn = false;
-
+        for (uint8_t i = 0; i < arpVoice.numOn; i++) {
+            AudioEngine::noteOn(arpVoice.trackId, arpVoice.notes[i], vel);
             if (isRecording)
-                recordNoteEvent(arpVoice.trackId, arpVoice.note, 0);
+                recordNoteEvent(arpVoice.trackId, arpVoice.notes[i], vel);
         }
+        arpVoice.note   = arpVoice.notes[0];
+        arpVoice.noteOn = arpVoice.numOn > 0;
+
+        arpVoice.offTick  = tick + max((uint32_t)(interval * arpGate), (uint32_t)1);
+        arpVoice.nextTick = (tick / interval + 1) * interval;    // stay on the grid
+        arpVoice.stepIndex++;
     }
 
     void onLoopWrap() {
 
         // ---------- ARP ----------
         if (arpVoice.active) {
-            if (arpVoice.noteOn) {
-                AudioEngine::noteOff(arpVoice.trackId, arpVoice.note);
-                if (isRecording)
-                    recordNoteEvent(arpVoice.trackId, arpVoice.note, 0);
-            }
-            arpVoice.noteOn   = false;
+            releaseArpNotes();
             arpVoice.nextTick = 0;      // relative to playhead
             arpVoice.offTick  = 0;
         }
@@ -545,6 +684,7 @@ namespace Sequencer {
             if (prerollTick >= PREROLL_TICKS) {
                 transport = PLAYING;
                 playheadTick = 0;
+                lastTickCycles = ARM_DWT_CYCCNT;
                 isPlaying = true;
                 prerollTick = 0;
                 tickOffset = tick;
@@ -560,18 +700,31 @@ namespace Sequencer {
         }
 
         playheadTick = patternTick;
+        lastTickCycles = ARM_DWT_CYCCNT;
+
+        const bool stepStart = (patternTick % TICKS_PER_STEP) == 0;
 
         for (uint8_t tr = 0; tr < MAX_TRACKS; tr++) {
             Track& track = curSeq().tracks[tr];
             if (!track.active || track.mute) continue;
-
-            // Sparse playback
-            for (uint8_t e = 0; e < track.pattern.count; e++) {
-                auto& ev = track.pattern.events[e];
-                if (ev.tick == patternTick) {  // only trigger events at this tick
-                    AudioEngine::pushPending(tr, ev.note, ev.value);
-                }
+            if (stepStart) Automation::onStepStart(tr);
+
+            // Sparse playback from the track's cursor. An event inserted
+            // before the cursor is skipped; a jump back re-seeks. Events
+            // play at their groove-warped tick, which stays within the bar.
+            const Pattern &p = track.pattern;
+            const uint16_t* groove = Groove::warpTable(tr);
+            uint16_t c = playCursor[tr];
+            if (c > p.count || (c > 0 && Groove::warp(groove, p.events[c - 1].tick) >= patternTick))
+                c = lowerBound(p, groove ? patternTick - patternTick % GROOVE_PERIOD : patternTick);
+            while (c < p.count && Groove::warp(groove, p.events[c].tick) < patternTick) c++;
+
+            for (; c < p.count && Groove::warp(groove, p.events[c].tick) == patternTick; c++) {
+                const Event &ev = p.events[c];
+                if (ev.type == EventType::CC) Automation::onControlEvent(tr, ev);
+                else AudioEngine::pushPending(tr, ev.note, ev.value);
             }
+            playCursor[tr] = c;
         }
 
         // NOTE REPEAT
@@ -584,7 +737,7 @@ namespace Sequencer {
     }
 
     void onStep(uint32_t stepIndex) {
-        updateSequencerDisplay(playheadTick);
+        updateSequencerDisplay(playheadTick);   // flag only, drawn by processDisplay()
     }
 
     void handleClockContinue() { scrubMode = false; }
@@ -634,6 +787,9 @@ namespace Sequencer {
         }
     }
 
+    // A record or overdub pass is one undo step, closed by stop
+    static bool recordPassOpen = false;
+
     void onStop() {
         uClock.stop();
         transport = STOPPED;
@@ -641,6 +797,11 @@ namespace Sequencer {
         isRecording = false;
         scrubMode = false;
         AudioEngine::allNotesOff();
+        Automation::releaseLocks();
+        if (recordPassOpen) {
+            recordPassOpen = false;
+            PatternEdit::end();
+        }
         playheadTick = 0;
         updateSequencerDisplay(playheadTick);
         Display::writeStr("rec.txt", isRecording? "REC":" ");
@@ -648,6 +809,10 @@ namespace Sequencer {
 
     // ------------------ PATTERN ------------------
     void onRecord() {
+        if (!recordPassOpen) {
+            recordPassOpen = true;
+            PatternEdit::begin();
+        }
         isRecording = true;
         playheadTick = 0;
         //allNotesOff();
@@ -658,6 +823,10 @@ namespace Sequencer {
     }
 
     void onOverdub() {
+        if (!recordPassOpen) {
+            recordPassOpen = true;
+            PatternEdit::begin();
+        }
         isRecording = true;
         playheadTick = 0;
         // Do NOT clear pattern, unlike normal record
@@ -666,12 +835,48 @@ namespace Sequencer {
         Display::writeStr("rec.txt", "OVER");
     }
 
+    // ------------------ CAPTURE TIMING ------------------
+    static uint32_t recordLatencyUs = RECORD_LATENCY_US;
+
+    void setRecordLatency(uint32_t us) { recordLatencyUs = us; }
+
+    // Position of an input captured at the given cycle count: the tick that
+    // was current then plus the fraction of a tick already elapsed, less the
+    // latency compensation, rounded to the nearest tick.
+    uint32_t captureTick(uint32_t cycles) {
+        uint32_t tick, tickCycles;
+        noInterrupts();
+        tick       = playheadTick;
+        tickCycles = lastTickCycles;
+        interrupts();
+
+        if (!isPlaying) return tick;
+
+        const float cyclesPerUs   = F_CPU_ACTUAL / 1000000.0f;
+        const float cyclesPerTick = cyclesPerUs * 60000000.0f / (bpm * PPQN);
+        float offset = ((int32_t)(cycles - tickCycles) - recordLatencyUs * cyclesPerUs) / cyclesPerTick;
+
+        int32_t len = getMaxTicks();
+        int32_t pos = ((int32_t)tick + (int32_t)floorf(offset + 0.5f)) % len;
+        return (pos < 0) ? pos + len : pos;
+    }
+
+    static void storeNoteEvent(uint8_t trackId, uint8_t note, uint8_t vel, uint32_t tick);
+
     void recordNoteEvent(uint8_t trackId, uint8_t note, uint8_t vel) {
         if (trackId >= MAX_TRACKS) return;
 
         uint32_t tick;
         ATOMIC(tick = playheadTick);
+        storeNoteEvent(trackId, note, vel, tick);
+    }
+
+    void recordNoteEventAt(uint8_t trackId, uint8_t note, uint8_t vel, uint32_t captureCycles) {
+        if (trackId >= MAX_TRACKS) return;
+        storeNoteEvent(trackId, note, vel, captureTick(captureCycles));
+    }
 
+    static void storeNoteEvent(uint8_t trackId, uint8_t note, uint8_t vel, uint32_t tick) {
         // Quantize ONLY note-on
         if (vel > 0 && quantizeEnabled) {
             uint32_t qTicks = divisionToTicks(quantizeDivision);
@@ -689,23 +894,28 @@ namespace Sequencer {
             if (track.pattern.events == nullptr) return; // still no memory
         }
 
-        // prevent overflow
-        if (track.pattern.count >= track.pattern.maxEvents) return;
-
-        // add event
-        track.pattern.events[track.pattern.count++] =
-            makeEvent(tick, note, vel);
+        // add event, drops it when the pattern is full
+        if (!insertEvent(track.pattern, makeEvent(tick, note, vel))) return;
 
         if (vel > 0) {
             markStepEvent(tick, note, vel);
+            markTrackEdited(trackId);
         }
 
-        updateSequencerDisplay(playheadTick);
+        viewportRedrawPending = true;
     }
 
     void clearPattern(uint8_t track) {
         Track& tr = curSeq().tracks[track];
 
+        // Journaled last to first, so undo refills the pattern in order
+        PatternEdit::begin();
+        noInterrupts();
+        for (uint16_t i = tr.pattern.count; i-- > 0; )
+            PatternEdit::logRemove(tr.pattern, i, tr.pattern.events[i]);
+        interrupts();
+        PatternEdit::end();
+
         // Release pattern slot if allocated
         if (tr.pattern.slotIndex >= 0) {
             freePatternSlot(tr.pattern.slotIndex);
@@ -713,6 +923,7 @@ namespace Sequencer {
         tr.pattern = {};  // reset struct safely
         // Reset pattern event count
         tr.pattern.count = 0;
+        markTrackEdited(track);
 
         // Reset step events
         for (uint16_t i = 0; i < getTotalSteps(); i++) {
@@ -722,19 +933,33 @@ namespace Sequencer {
         }
 
         // Clear visible cells
+        static const uint8_t emptyRow[DISPLAY_STEPS] = {};
         for (uint8_t row = 0; row < MAX_NOTES_DISPLAY; row++) {
-            for (uint8_t col = 0; col < Grid::stepsVisible; col++) {
-                uint16_t cellIndex = row * Grid::stepsVisible + col;
-                if (lastCellState[cellIndex]) {
-                    drawGridCellPrebuilt(col, row, false);
-                    lastCellState[cellIndex] = false;
-                }
-            }
+            drawGridRow(row, emptyRow);
         }
 
         lastPhStep = -1;
         lastViewStartStep = view.startStep;
-        updatePlayhead(view.startStep);
+        updatePlayhead(playheadTick);
+    }
+
+    // Rebuilds the step flags from every track, after edits that bypass
+    // recording (undo, redo)
+    void refreshStepFlags() {
+        for (uint16_t i = 0; i < getTotalSteps(); i++) {
+            stepHasEvent[i] = false;
+            for (uint8_t n = 0; n < NOTE_RANGE; n++)
+                stepNoteHasEvent[i][n] = false;
+        }
+        for (uint8_t t = 0; t < MAX_TRACKS; t++) {
+            const Pattern &p = curSeq().tracks[t].pattern;
+            for (uint16_t i = 0; i < p.count; i++) {
+                const Event &e = p.events[i];
+                if (e.type == EventType::NOTE_ON && e.note < NOTE_RANGE)
+                    markStepEvent(e.tick, e.note, e.value);
+            }
+        }
+        viewportRedrawPending = true;
     }
 
     void markStepEvent(uint32_t tick, uint8_t note, uint8_t vel) {
@@ -768,38 +993,82 @@ namespace Sequencer {
         // recalc display steps per bar
         display_steps_per_bar = (uint8_t)(DISPLAY_STEPS / view.barsOnDisplay); // e.g., 32 / 0.5 = 64
         // Redraw piano roll
-        initPianoRollXSTR();
         drawPianoRoll();
     }
 
-    // ------------------ GRID ------------------
-    char xstrCellOn[MAX_NOTES_DISPLAY][Grid::stepsVisible][64];
-    char xstrCellOff[MAX_NOTES_DISPLAY][Grid::stepsVisible][64];
+    // Full repaint after returning from another display page
+    void redrawPage() {
+        initView(static_cast<uint8_t>(zoomLevel));
+        Display::writeNum("bpm.val", bpm);
+        Display::writeNum("length.val", seqLength);
+        setQuantizeEnabled(quantizeEnabled);
+        setRepeatDivision(noteRepeatRate);
+        setArpMode(arpMode);
+        setCurrentTrack(currentTrack);
+        updateSequencerDisplay(playheadTick);
+        Meters::invalidate();
+    }
 
-    void initGridXSTR() {
-        for (uint8_t row = 0; row < MAX_NOTES_DISPLAY; row++) {
-            for (uint8_t col = 0; col < Grid::stepsVisible; col++) {
-                uint16_t x = Grid::startX + col * (Grid::stepW + Grid::spacingX);
-                uint16_t y = Grid::startY + row * (Grid::rowHeight + Grid::spacingY);
-
-                // ON version
-                sprintf(xstrCellOn[row][col],
-                        "xstr %u,%u,%u,%u,0,%u,0,1,1,1,\"X\"\xff\xff\xff",
-                        x, y, Grid::stepW, Grid::rowHeight, Grid::fgOn);
-
-                // OFF version
-                sprintf(xstrCellOff[row][col],
-                        "xstr %u,%u,%u,%u,0,%u,0,1,1,1,\" \"\xff\xff\xff",
-                        x, y, Grid::stepW, Grid::rowHeight, Grid::fgOff);
+    // ------------------ GRID ------------------
+    // One fill per run of cells. A note bar covers the gaps between its own
+    // cells; gaps next to an empty cell or between two notes are background,
+    // so clearing a run leaves nothing behind.
+    void drawGridRun(uint8_t row, uint8_t col, uint8_t cells, bool on, bool joinLeft, bool joinRight) {
+        constexpr uint16_t pitch = Grid::stepW + Grid::spacingX;
+
+        uint16_t x = Grid::startX + col * pitch;
+        uint16_t w = cells * pitch - Grid::spacingX;
+        uint16_t y = Grid::startY + row * (Grid::rowHeight + Grid::spacingY);
+
+        if (joinLeft)  { x -= Grid::spacingX; w += Grid::spacingX; }
+        if (joinRight) { w += Grid::spacingX; }
+
+        Display::Cmd("fill").num(x).num(y).num(w).num(Grid::rowHeight)
+                            .num(on ? Grid::fgOn : Grid::fgOff).send();
+    }
+
+    // Clears the gap left of col, once part of a bar that has been split
+    void clearGridGap(uint8_t row, uint8_t col) {
+        uint16_t x = Grid::startX + col * (Grid::stepW + Grid::spacingX) - Grid::spacingX;
+        uint16_t y = Grid::startY + row * (Grid::rowHeight + Grid::spacingY);
+        Display::Cmd("fill").num(x).num(y).num(Grid::spacingX).num(Grid::rowHeight)
+                            .num(Grid::fgOff).send();
+    }
+
+    // Diffs a row against lastCellState. An empty run starts at a changed
+    // cell and extends over following empty cells, changed or not, so
+    // unchanged cells bridge two changes into one command. A changed note
+    // cell redraws its whole bar with a single fill.
+    void drawGridRow(uint8_t row, const uint8_t* cells) {
+        uint8_t* last = &lastCellState[row * DISPLAY_STEPS];
+        uint8_t col = 0;
+
+        while (col < DISPLAY_STEPS) {
+            if (last[col] == cells[col]) { col++; continue; }
+
+            if (cells[col] == CELL_EMPTY) {
+                uint8_t start = col;
+                uint8_t end   = col;       // last changed cell of the run
+                while (col < DISPLAY_STEPS && cells[col] == CELL_EMPTY) {
+                    if (last[col] != CELL_EMPTY) end = col;
+                    last[col] = CELL_EMPTY;
+                    col++;
+                }
+                drawGridRun(row, start, end - start + 1, false, start > 0, end + 1 < DISPLAY_STEPS);
+                continue;
             }
-        }
-    }
 
-    inline void drawGridCellPrebuilt(uint8_t col, uint8_t row, bool noteActive) {
-        if (noteActive) {
-            Display::writeCmd(xstrCellOn[row][col]);
-        } else {
-            Display::writeCmd(xstrCellOff[row][col]);
+            uint8_t start = col;
+            while (start > 0 && cells[start] == CELL_BODY) start--;
+            uint8_t end = col;
+            while (end + 1 < DISPLAY_STEPS && cells[end + 1] == CELL_BODY) end++;
+
+            if (start > 0 && last[start] == CELL_BODY && cells[start - 1] != CELL_EMPTY)
+                clearGridGap(row, start);
+            for (uint8_t c = start; c <= end; c++) last[c] = cells[c];
+
+            drawGridRun(row, start, end - start + 1, true, false, false);
+            col = end + 1;
         }
     }
 
@@ -814,39 +1083,31 @@ namespace Sequencer {
         constexpr uint16_t bgColor      = 0;          // Black/erase
     }
 
-    char xstrNoteLabel[MAX_NOTES_DISPLAY][NOTE_RANGE];
-
+    // Fixed 4 columns: "C  2", "C#-1"
     void getNoteName(uint8_t note, char* out) {
-        static const char* names[12] = {"C","C#","D","D#","E","F","F#","G","G#","A","A#","B"};
-        uint8_t nameIndex = note % 12;
+        static const char* names[12] = {"C ","C#","D ","D#","E ","F ","F#","G ","G#","A ","A#","B "};
+        const char* name = names[note % 12];
         int8_t octave = (note / 12) - 2;
 
-        // Always 4 chars
-        if (octave < 0) {
-            sprintf(out, "%-2s%d ", names[nameIndex], octave);  // e.g., "C -2 "
-        } else {
-            sprintf(out, "%-2s %d", names[nameIndex], octave);  // e.g., "C  2 "
-        }
+        out[0] = name[0];
+        out[1] = name[1];
+        uint8_t len = 2;
+        if (octave >= 0) out[len++] = ' ';
+        len += Display::formatInt(out + len, octave);
+        out[len] = 0;
     }
 
-    void initPianoRollXSTR() {
+    void drawPianoRoll() {
         for (uint8_t row = 0; row < view.notesOnDisplay; row++) {
             uint16_t y = PianoRoll::startY + row * (PianoRoll::rowHeight + PianoRoll::spacingY);
-            uint8_t note = view.startNote + row;
 
-            char noteName[5];  // 4 chars + null
-            getNoteName(note, noteName);
+            char noteName[6];
+            getNoteName(view.startNote + row, noteName);
 
-            // Prebuild XSTR command for this note label
-            sprintf(xstrNoteLabel[row],
-                    "xstr %u,%u,%u,%u,1,%u,0,0,1,1,\"%s\"\xff\xff\xff",
-                    PianoRoll::startX, y, PianoRoll::width, PianoRoll::rowHeight, PianoRoll::fgColor, noteName);
-        }
-    }
-
-    void drawPianoRoll() {
-        for (uint8_t row = 0; row < view.notesOnDisplay; row++) {
-            Display::writeCmd(xstrNoteLabel[row]);
+            Display::Cmd("xstr").num(PianoRoll::startX).num(y)
+                .num(PianoRoll::width).num(PianoRoll::rowHeight)
+                .num(1).num(PianoRoll::fgColor).num(0).num(0).num(1).num(1)
+                .str(noteName).send();
         }
     }
 
@@ -862,7 +1123,6 @@ namespace Sequencer {
         if (newStart != view.startNote) {
             view.startNote = (uint8_t)newStart;
             viewportRedrawPending = true;   
-            initPianoRollXSTR();
         }
     }
 
@@ -872,24 +1132,13 @@ namespace Sequencer {
     #define GRID_H 236            
     #define STEP_W 16 
 
-    char playheadCmd[DISPLAY_STEPS][64];
-    char playheadEraseCmd[DISPLAY_STEPS][64];
-
-    void initPlayheadCmds(uint16_t stepsVisible, uint16_t gridY, uint16_t gridH) {
-        for (uint16_t col = 0; col < stepsVisible; col++) {
-            uint16_t x = X_OFFSET + (DISPLAY_PIXELS / stepsVisible) * col;
-            uint16_t xEnd = x + (DISPLAY_PIXELS / stepsVisible) - 2;
+    // Outline around one grid column; color 0 erases
+    void drawPlayheadColumn(int16_t col, uint16_t color) {
+        constexpr uint16_t colW = DISPLAY_PIXELS / DISPLAY_STEPS;
+        uint16_t x = X_OFFSET + colW * col;
 
-            // Draw playhead
-            sprintf(playheadCmd[col],
-                    "draw %u,%u,%u,%u,%u\xff\xff\xff",
-                    x, gridY, xEnd, gridY + gridH, PLAYHEAD_COLOR);
-
-            // Erase playhead
-            sprintf(playheadEraseCmd[col],
-                    "draw %u,%u,%u,%u,0\xff\xff\xff",
-                    x, gridY, xEnd, gridY + gridH);
-        }
+        Display::Cmd("draw").num(x).num(GRID_Y).num(x + colW - 2).num(GRID_Y + GRID_H)
+                            .num(color).send();
     }
 
     void movePlayheadColumns(int8_t delta) {
@@ -912,15 +1161,15 @@ namespace Sequencer {
         updateSequencerDisplay(playheadTick);
     }
 
-    void updatePlayhead(uint32_t stepIndex) {
-        int16_t newPhCol = (playheadTick - view.startStep * TICKS_PER_STEP) / getTicksPerColumn();
+    void updatePlayhead(uint32_t playTick) {
+        int16_t newPhCol = ((int32_t)playTick - (int32_t)(view.startStep * TICKS_PER_STEP)) / (int32_t)getTicksPerColumn();
 
         if (lastPhStep >= 0 && lastPhStep < DISPLAY_STEPS) {
-            Display::writeCmd(playheadEraseCmd[lastPhStep]);
+            drawPlayheadColumn(lastPhStep, 0);
         }
 
         if (newPhCol >= 0 && newPhCol < DISPLAY_STEPS) {
-            Display::writeCmd(playheadCmd[newPhCol]);
+            drawPlayheadColumn(newPhCol, PLAYHEAD_COLOR);
             lastPhStep = newPhCol;
         } else {
             lastPhStep = -1;
@@ -931,7 +1180,7 @@ namespace Sequencer {
     void setZoom(ZoomLevel z) {
         // Erase playhead BEFORE changing zoom
         if (lastPhStep >= 0 && lastPhStep < DISPLAY_STEPS) {
-            Display::writeCmd(playheadEraseCmd[lastPhStep]);
+            drawPlayheadColumn(lastPhStep, 0);
             lastPhStep = -1;
         }
 
@@ -940,7 +1189,7 @@ namespace Sequencer {
         const uint8_t bars = static_cast<uint8_t>(z);
         initView(bars);
         alignViewportToPlayhead(playheadTick / TICKS_PER_STEP);
-        updatePlayhead(playheadTick / TICKS_PER_STEP);
+        updatePlayhead(playheadTick);
 
         // Update zoom label
         const char* txt = "X?";
@@ -1009,12 +1258,8 @@ namespace Sequencer {
         if (lastBar > maxBar) lastBar = maxBar;
 
         // Clear ruler area
-        char clearCmd[64];
-        sprintf(clearCmd,
-            "fill %u,%u,%u,%u,0\xff\xff\xff",
-            X_OFFSET, BarRuler::startY,
-            DISPLAY_PIXELS, BarRuler::height);
-        Display::writeCmd(clearCmd);
+        Display::Cmd("fill").num(X_OFFSET).num(BarRuler::startY)
+                            .num(DISPLAY_PIXELS).num(BarRuler::height).num(0).send();
 
         // Draw bar numbers
         for (uint32_t bar = firstBar; bar <= lastBar; bar++) {
@@ -1024,58 +1269,113 @@ namespace Sequencer {
             float norm = float(barTick - viewStartTick) / float(viewTicks);
             uint16_t x = X_OFFSET + norm * DISPLAY_PIXELS;
 
-            char cmd[64];
-            sprintf(cmd,
-                "xstr %u,%u,20,%u,1,%u,0,0,1,1,\"%lu\"\xff\xff\xff",
-                x,
-                BarRuler::startY,
-                BarRuler::height,
-                BarRuler::fgColor,
-                bar + 1);
+            char label[12];
+            label[Display::formatInt(label, bar + 1)] = 0;
 
-            Display::writeCmd(cmd);
+            Display::Cmd("xstr").num(x).num(BarRuler::startY).num(20).num(BarRuler::height)
+                .num(1).num(BarRuler::fgColor).num(0).num(0).num(1).num(1)
+                .str(label).send();
         }
     }
 
     // ------------------ GRID UPDATE ------------------
-    bool hasTrigInRange(uint8_t note, uint32_t startTick, uint32_t endTick) {
-        auto& pat = curTrack().pattern;
+    // Marks the columns covered by [onTick, offTick), clipped to the view
+    static void markNoteBar(uint8_t* cells, uint32_t onTick, uint32_t offTick,
+                            uint32_t viewStart, uint32_t ticksPerColumn) {
+        if (offTick <= onTick) offTick = onTick + 1;
+        if (offTick <= viewStart) return;
+
+        uint32_t first = (onTick < viewStart) ? 0 : (onTick - viewStart) / ticksPerColumn;
+        uint32_t last  = (offTick - 1 - viewStart) / ticksPerColumn;
+        if (first >= DISPLAY_STEPS) return;
+        if (last >= DISPLAY_STEPS) last = DISPLAY_STEPS - 1;
+
+        // A bar entering from the left edge has no head
+        cells[first] = (onTick < viewStart) ? (cells[first] ? cells[first] : CELL_BODY) : CELL_HEAD;
+        for (uint32_t c = first + 1; c <= last; c++)
+            if (cells[c] == CELL_EMPTY) cells[c] = CELL_BODY;
+    }
+
+    // One pass over the sorted pattern, pairing each note-on with the next
+    // note-off (or retrigger) of the same note
+    void buildRowCells(uint8_t note, uint8_t* cells) {
+        memset(cells, CELL_EMPTY, DISPLAY_STEPS);
+
+        const Pattern &pat = curTrack().pattern;
+        if (!pat.events) return;
+
+        uint32_t ticksPerColumn = getTicksPerColumn();
+        uint32_t viewStart      = view.startStep * TICKS_PER_STEP;
+        uint32_t viewEnd        = viewStart + ticksPerColumn * DISPLAY_STEPS;
+
+        bool     open   = false;
+        uint32_t onTick = 0;
+
         for (uint16_t i = 0; i < pat.count; i++) {
-            const auto& e = pat.events[i];
-            if (e.tick >= endTick) break;  // sorted -> done
-            if (e.tick >= startTick && e.note == note && e.value > 0) return true;
+            const Event &e = pat.events[i];
+            if (e.tick >= viewEnd) break;
+            if (e.note != note || e.type == EventType::CC) continue;
+
+            if (open) markNoteBar(cells, onTick, e.tick, viewStart, ticksPerColumn);
+            open   = (e.type == EventType::NOTE_ON);
+            onTick = e.tick;
         }
-        return false;
+        // Still held at the view end (or never released)
+        if (open) markNoteBar(cells, onTick, viewEnd, viewStart, ticksPerColumn);
     }
 
-    void processDisplay() {
-        if (!viewportRedrawPending) return;
-        viewportRedrawPending = false;
-
-        drawPianoRoll();
-        drawBarRuler();
-        
-        uint32_t ticksPerColumn =
-            (TICKS_PER_BAR * view.barsOnDisplay) / DISPLAY_STEPS;
+    void drawGridRowFromPattern(uint8_t row) {
+        uint8_t cells[DISPLAY_STEPS];
+        buildRowCells(view.startNote + row, cells);
+        drawGridRow(row, cells);
+    }
 
-        uint32_t viewStartTick = view.startStep * TICKS_PER_STEP;
+    // ------------------ UI TASK ------------------
+    static volatile bool uiPlayheadDirty = true;
+    static elapsedMillis uiFrameTimer;
+    static uint8_t gridRowCursor = MAX_NOTES_DISPLAY;   // next row of a running redraw
 
-        for (uint8_t col = 0; col < DISPLAY_STEPS; col++) {
+    struct TransportSnapshot {
+        uint32_t tick;
+        bool     playheadDirty;
+    };
+
+    // One consistent view of the clock-side state per frame
+    static TransportSnapshot takeSnapshot() {
+        TransportSnapshot s;
+        noInterrupts();
+        s.tick          = playheadTick;
+        s.playheadDirty = uiPlayheadDirty;
+        uiPlayheadDirty = false;
+        interrupts();
+        return s;
+    }
+
+    // Playhead and counters first, then grid rows until the frame budget is
+    // spent; an unfinished redraw continues on the next frame.
+    void processDisplay() {
+        if (Display::getPage() != Display::PAGE_MAIN) return;
+        if (uiFrameTimer < DISPLAY_FRAME_MS) return;
+        uiFrameTimer = 0;
+        elapsedMicros frameTime;
 
-            uint32_t colStart = viewStartTick + col * ticksPerColumn;
-            uint32_t colEnd   = colStart + ticksPerColumn;
+        TransportSnapshot s = takeSnapshot();
 
-            for (uint8_t row = 0; row < view.notesOnDisplay; row++) {
-                uint8_t note = view.startNote + row;
+        if (s.playheadDirty) {
+            alignViewportToPlayhead(s.tick / TICKS_PER_STEP);
+            updatePlayhead(s.tick);
+            counter(s.tick);
+        }
 
-                bool active = hasTrigInRange(note, colStart, colEnd);
+        if (viewportRedrawPending) {
+            viewportRedrawPending = false;
+            gridRowCursor = 0;
+            drawPianoRoll();
+            drawBarRuler();
+        }
 
-                uint16_t cellIndex = col + row * DISPLAY_STEPS;
-                if (lastCellState[cellIndex] != active) {
-                    drawGridCellPrebuilt(col, row, active);
-                    lastCellState[cellIndex] = active;
-                }
-            }
+        while (gridRowCursor < view.notesOnDisplay && Display::frameBudgetLeft(frameTime)) {
+            drawGridRowFromPattern(gridRowCursor++);
         }
     }
 
@@ -1101,15 +1401,9 @@ namespace Sequencer {
     }
 
     // ------------------ DISPLAY UPDATE ------------------
+    // Drawn from the transport snapshot on the next UI frame
     void updateSequencerDisplay(uint32_t playTick) {
-        uint16_t stepIndex = playTick / TICKS_PER_STEP;
-
-        alignViewportToPlayhead(stepIndex);
-        viewportRedrawPending = true;
-
-        updatePlayhead(stepIndex);
-        counter(playTick); 
-
+        uiPlayheadDirty = true;
     }
 
     // ----------------------------------------------------------------------------------//
@@ -1166,11 +1460,10 @@ namespace Sequencer {
         }
         setCurrentTrack(0);
         // Display & playhead
-        initGridXSTR();
-        initPlayheadCmds(Grid::stepsVisible, GRID_Y, GRID_H);
         playheadTick = 0;
         lastPhStep = -1;
         viewportRedrawPending = true;
+        Display::setWidgetInterval("bpm.val", 50);
 
         // CLOCK setup
         uClock.setOutputPPQN(uClock.PPQN_96); 
@@ -1284,6 +1577,10 @@ namespace Sequencer {
             }
         }
 
+        sortPattern(lead.pattern);
+        sortPattern(bass.pattern);
+        markTrackEdited(0);
+        markTrackEdited(1);
         viewportRedrawPending = true;
     }
 
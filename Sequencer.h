@@ -33,7 +33,7 @@ namespace Sequencer {
 
     // ------------------ DATA STRUCTURE--------------------- //
     constexpr uint16_t MAX_EVENTS_PER_PATTERN = 1024;
-    enum class EventType { NOTE_ON, NOTE_OFF, CC };
+    enum class EventType : uint8_t { NOTE_ON, NOTE_OFF, CC };     // Event packs into 8 bytes
 
     struct Event {
         uint32_t tick;       // absolute tick
@@ -65,6 +65,7 @@ namespace Sequencer {
         bool mute   = false;
         uint8_t type = 0;
         uint8_t midiCh = 1;
+        uint8_t engine = 0;   // synth engine id
 
         Pattern pattern;  // pattern with sparse events
     };
@@ -99,6 +100,7 @@ namespace Sequencer {
     void setCurrentTrack(uint8_t t);
     uint8_t getCurrentTrack();
     void setTrackType(TrackType type);
+    void assignTrackToEngine(uint8_t engine);
     void toggleTrackMute(uint8_t track);
     extern bool isTrackMuted(uint8_t track);
     void initTrack(Track& tr, uint8_t index);
@@ -107,6 +109,10 @@ namespace Sequencer {
     extern bool trackHasPatternData(uint8_t trackIndex);
     void clearPattern(uint8_t track);
     void initPattern(Track& tr);
+    bool insertEvent(Pattern& p, const Event& e);   // keeps events sorted by tick
+    bool removeEvent(Pattern& p, uint16_t index);
+    uint16_t lowerBound(const Pattern& p, uint32_t tick);   // first event at or after tick
+    void sortPattern(Pattern& p);
 
     // EVENT
     inline Event makeEvent(uint32_t tick, uint8_t note, uint8_t vel) {
@@ -117,7 +123,17 @@ namespace Sequencer {
         e.value = vel;
         return e;
     }
+    // Pattern order. Same tick: note-offs, then controls, then note-ons, so
+    // a retrigger pairs with the note it ends and a lock is set before its note
+    inline uint8_t eventRank(EventType t) {
+        return (t == EventType::NOTE_OFF) ? 0 : (t == EventType::CC) ? 1 : 2;
+    }
+    inline bool eventBefore(const Event &a, const Event &b) {
+        if (a.tick != b.tick) return a.tick < b.tick;
+        return eventRank(a.type) < eventRank(b.type);
+    }
     void markStepEvent(uint32_t tick, uint8_t note, uint8_t vel);
+    void refreshStepFlags();
     extern bool stepNoteHasEvent[MAX_PATTERN_STEPS][NOTE_RANGE];
 
     // TRANSPORT
@@ -137,6 +153,11 @@ namespace Sequencer {
 
     // RECORD
     void recordNoteEvent(uint8_t trackId, uint8_t note, uint8_t vel);
+    // Live input: recorded where the playhead was at capture (ARM_DWT_CYCCNT)
+    #define RECORD_LATENCY_US 0     // subtracted from capture time, e.g. pad poll delay
+    void recordNoteEventAt(uint8_t trackId, uint8_t note, uint8_t vel, uint32_t captureCycles);
+    void setRecordLatency(uint32_t us);
+    uint32_t captureTick(uint32_t cycles);
     void onOverdub();
     void onRecord();
 
@@ -201,20 +222,27 @@ namespace Sequencer {
     void stopNoteRepeat(uint8_t note);
 
     // ARPEGGIATOR
-    enum class ArpMode {OFF, UP_OCTAVE, HELD_NOTES };
+    #define MAX_ARP_VOICES    8     // held notes, and notes of one CHORD step
+    #define MAX_ARP_OCTAVES   4
+    #define MAX_ARP_SEQ      (2 * MAX_ARP_VOICES * MAX_ARP_OCTAVES)
+
+    enum class ArpMode { OFF, UP, DOWN, UP_DOWN, RANDOM, AS_PLAYED, CHORD };
     struct ArpVoice {
         bool active = false;
-        uint8_t note = 0;
+        uint8_t note = 0;               // lowest note of the current step
         bool noteOn = false;
-        uint32_t nextTick = 0;
+        uint8_t notes[MAX_ARP_VOICES];  // sounding
+        uint8_t numOn = 0;
+        uint32_t nextTick = 0;          // on the arp rate grid
         uint32_t offTick = 0;
-        uint8_t stepIndex = 0;
-        uint8_t  trackId;
+        uint16_t stepIndex = 0;
+        uint8_t  trackId = 0;
     };
 
     extern ArpMode arpMode;
     extern uint8_t arpOctaves;
     extern float arpGate;
+    extern bool arpLatch;
     extern uint8_t numHeldNotes;
     extern ArpVoice arpVoice;
 
@@ -223,6 +251,8 @@ namespace Sequencer {
     void stopArp(uint8_t note);
     void processArp(uint32_t tick);
     void setArpMode(ArpMode mode);
+    void setArpLatch(bool on);          // held set stays after release
+    void resetArp();                    // releases notes, clears held and latched set
 
     // ------------------ VIEW ----------------------- //
     struct ViewPort {
@@ -234,8 +264,12 @@ namespace Sequencer {
         uint8_t  notesOnDisplay;
     };
     extern ViewPort view;
-    extern bool viewportRedrawPending;
+    extern volatile bool viewportRedrawPending;
+    // Bit per track, set whenever a track's pattern or mute state changes
+    void markTrackEdited(uint8_t track);
+    uint32_t takeTrackEdits();          // returns and clears the mask
     void initView(uint8_t zoomBars);
+    void redrawPage();
     void updateDisplayPlayhead();
     extern uint8_t lastCellState[DISPLAY_STEPS * MAX_NOTES_DISPLAY];
 
@@ -251,7 +285,12 @@ namespace Sequencer {
         constexpr uint16_t fgOn         = 65535;
         constexpr uint16_t fgOff        = 0;
     }
-    inline void drawGridCellPrebuilt(uint8_t col, uint8_t row, bool noteActive);
+    enum CellState : uint8_t {
+        CELL_EMPTY = 0,
+        CELL_HEAD,          // column holding a note-on
+        CELL_BODY           // held part of the note
+    };
+    void drawGridRow(uint8_t row, const uint8_t* cells);
     void drawBarRuler();
 
     // ZOOM
@@ -269,16 +308,17 @@ namespace Sequencer {
     extern volatile uint32_t playheadTick;
     extern int16_t lastPhStep;
     extern uint16_t lastViewStartStep;
-    void updatePlayhead(uint32_t stepIndex);
+    void updatePlayhead(uint32_t playTick);
     void movePlayheadColumns(int8_t delta);
     void alignViewportToPlayhead(uint32_t stepIndex);
 
     // PIANO ROLL
-    void initPianoRollXSTR();
     void drawPianoRoll();
     void scrollNotes(int8_t delta);
 
     // PROCESS
+    // UI task, call from loop(). Everything else only marks the view dirty,
+    // which is safe from the clock interrupt.
     void processDisplay();
     void updateSequencerDisplay(uint32_t playTick);
 
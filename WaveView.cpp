@@ -0,0 +1,118 @@
+#include "WaveView.h"
+#include "Display.h"
+#include "Sequencer.h"
+
+namespace WaveView {
+
+    static constexpr uint16_t columns = WAVE_W / WAVE_COL_W;
+    static constexpr uint16_t centerY = WAVE_Y + WAVE_H / 2;
+
+    static int8_t   sampleIdx = -1;
+    static uint32_t rangeStart = 0;
+    static uint32_t rangeEnd   = 0;
+    static bool     active = false;
+    static bool     clearPending = false;
+    static uint16_t columnCursor = columns;     // == columns when done
+
+    static elapsedMillis frameTimer;
+
+    static void restart() {
+        clearPending = true;
+        columnCursor = 0;
+    }
+
+    void show(int8_t idx) {
+        if (idx < 0 || idx >= MAX_SAMPLES || !AudioEngine::samplePool[idx].data) return;
+        sampleIdx  = idx;
+        rangeStart = 0;
+        rangeEnd   = AudioEngine::samplePool[idx].length;
+        active     = true;
+
+        Display::setPage(Display::PAGE_SAMPLE);
+        Display::writeStr("wname.txt", AudioEngine::samplePool[idx].filename);
+        restart();
+    }
+
+    void hide() {
+        if (!active) return;
+        active = false;
+        Display::setPage(Display::PAGE_MAIN);
+        Sequencer::redrawPage();
+    }
+
+    bool isActive() { return active; }
+
+    void setRange(uint32_t start, uint32_t end) {
+        if (sampleIdx < 0) return;
+        const AudioEngine::Sample &s = AudioEngine::samplePool[sampleIdx];
+        end = min(end, s.length);
+        if (start >= end) return;
+        rangeStart = start;
+        rangeEnd   = end;
+        restart();
+    }
+
+    // Min/max of frames [f0, f1) from the coarsest level that still has at
+    // least one peak per column; raw frames when zoomed in past level 0.
+    static AudioEngine::PeakPair columnPeak(const AudioEngine::Sample &s, uint32_t f0, uint32_t f1) {
+        uint32_t span = f1 - f0;
+
+        if (span < PEAK_BASE_FRAMES || !s.peaks[0]) {
+            int16_t lo = s.data[f0], hi = s.data[f0];
+            for (uint32_t f = f0 + 1; f < f1; f++) {
+                if (s.data[f] < lo) lo = s.data[f];
+                if (s.data[f] > hi) hi = s.data[f];
+            }
+            return { (int8_t)(lo >> 8), (int8_t)(hi >> 8) };
+        }
+
+        uint8_t level = 0;
+        while (level + 1 < PEAK_LEVELS && AudioEngine::peakFrames(level + 1) <= span) level++;
+
+        uint32_t pf = AudioEngine::peakFrames(level);
+        uint32_t p0 = f0 / pf;
+        uint32_t p1 = min((f1 + pf - 1) / pf, s.peakCount[level]);
+        AudioEngine::PeakPair pk = s.peaks[level][p0];
+        for (uint32_t p = p0 + 1; p < p1; p++) {
+            if (s.peaks[level][p].min < pk.min) pk.min = s.peaks[level][p].min;
+            if (s.peaks[level][p].max > pk.max) pk.max = s.peaks[level][p].max;
+        }
+        return pk;
+    }
+
+    static void drawColumn(const AudioEngine::Sample &s, uint16_t col) {
+        uint32_t span = rangeEnd - rangeStart;
+        uint32_t f0 = rangeStart + (uint64_t)span * col / columns;
+        uint32_t f1 = rangeStart + (uint64_t)span * (col + 1) / columns;
+        if (f1 <= f0) f1 = f0 + 1;
+        if (f1 > rangeEnd) return;
+
+        AudioEngine::PeakPair pk = columnPeak(s, f0, f1);
+        int16_t top = centerY - (int16_t)pk.max * (WAVE_H / 2) / 128;
+        int16_t bot = centerY - (int16_t)pk.min * (WAVE_H / 2) / 128;
+        Display::Cmd("fill").num(WAVE_X + col * WAVE_COL_W).num(top)
+                            .num(WAVE_COL_W).num(bot - top + 1)
+                            .num(Colors::wave).send();
+    }
+
+    void process() {
+        if (!active || Display::getPage() != Display::PAGE_SAMPLE) return;
+        if (frameTimer < DISPLAY_FRAME_MS) return;
+        frameTimer = 0;
+        elapsedMicros frameTime;
+
+        if (clearPending) {
+            clearPending = false;
+            Display::Cmd("fill").num(WAVE_X).num(WAVE_Y).num(WAVE_W).num(WAVE_H)
+                                .num(Colors::bg).send();
+            Display::Cmd("fill").num(WAVE_X).num(centerY).num(WAVE_W).num(1)
+                                .num(Colors::center).send();
+        }
+
+        const AudioEngine::Sample &s = AudioEngine::samplePool[sampleIdx];
+        while (columnCursor < columns && Display::frameBudgetLeft(frameTime)) {
+            drawColumn(s, columnCursor++);
+        }
+    }
+
+} // namespace WaveView
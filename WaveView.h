@@ -0,0 +1,32 @@
+#ifndef WAVEVIEW_H
+#define WAVEVIEW_H
+
+#include <Arduino.h>
+#include "AudioEngine.h"
+
+namespace WaveView {
+
+    // ------------------ CONFIG ------------------
+    #define WAVE_X          144
+    #define WAVE_Y          140
+    #define WAVE_W          512
+    #define WAVE_H          200
+    #define WAVE_COL_W        2     // pixels per drawn column
+
+    namespace Colors {
+        constexpr uint16_t bg     = 0;
+        constexpr uint16_t wave   = 65535;
+        constexpr uint16_t center = 12678;
+    }
+
+    // Draws a sample on PAGE_SAMPLE from its peak overview. Columns are sent
+    // a few per frame, so a redraw never stalls the loop.
+    void show(int8_t sampleIdx);        // switches page and draws the whole sample
+    void hide();                        // back to the sequencer page
+    bool isActive();
+    void setRange(uint32_t start, uint32_t end);    // zoom, in frames
+    void process();                     // call from loop()
+
+} // namespace WaveView
+
+#endif
@@ -19,7 +19,7 @@ static constexpr uint8_t NUM_VOICES = 4;
         ARP_MODE,
         ARP_GATE,
         MAIN_VOL,
-        MAIN_2,
+        SWING,
         MAIN_3,
         MAIN_4,
     };